@@ -0,0 +1,65 @@
+#include "Clipmap.h"
+
+void FClipmap::AddLevel(int level, int gridResolution, float cellSize, int inset, TArray<FVector>& vertices, TArray<int32>& triangles, TArray<FVector>& normals)
+{
+	float levelCellSize = cellSize * (1 << level);
+	int half = gridResolution / 2;
+	int firstVertex = vertices.Num();
+
+	// Grid of vertices for this level
+	for (int y = -half; y <= half; y++)
+	{
+		for (int x = -half; x <= half; x++)
+		{
+			vertices.Add(FVector(x * levelCellSize, y * levelCellSize, 0));
+			normals.Add(FVector::UpVector);
+		}
+	}
+
+	int inner = half / 2 - inset;
+	for (int y = -half; y < half; y++)
+	{
+		for (int x = -half; x < half; x++)
+		{
+			// Skip the centre of the level, it is covered by the level inside
+			if (level > 0 && x >= -inner && x < inner && y >= -inner && y < inner)
+			{
+				continue;
+			}
+
+			int a = firstVertex + (y + half) * (gridResolution + 1) + (x + half);
+			int b = a + 1;
+			int c = a + gridResolution + 1;
+			int d = c + 1;
+
+			triangles.Append({ a, c, b, b, c, d });
+		}
+	}
+}
+
+FVector FClipmap::Snap(FVector location, float cellSize, int levels, float z)
+{
+	float snap = cellSize * (1 << (levels - 1));
+	return FVector(FMath::GridSnap(location.X, snap), FMath::GridSnap(location.Y, snap), z);
+}
+
+void FClipmap::UpdateRegions(UTexture2D* texture, const TArray<FUpdateTextureRegion2D>& regions, const void* data, int dataSize, uint32 pitch, uint32 bytesPerPixel)
+{
+	if (!texture || regions.Num() == 0)
+	{
+		return;
+	}
+
+	// Region and data are freed once the render thread has copied them
+	auto regionsCopy = new FUpdateTextureRegion2D[regions.Num()];
+	FMemory::Memcpy(regionsCopy, regions.GetData(), regions.Num() * sizeof(FUpdateTextureRegion2D));
+	auto dataCopy = new uint8[dataSize];
+	FMemory::Memcpy(dataCopy, data, dataSize);
+
+	texture->UpdateTextureRegions(0, regions.Num(), regionsCopy, pitch, bytesPerPixel, dataCopy,
+		[](uint8* srcData, const FUpdateTextureRegion2D* srcRegions)
+		{
+			delete[] srcData;
+			delete[] srcRegions;
+		});
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/Texture2D.h"
+
+// Helpers shared by the camera centred clipmap meshes (water and far terrain)
+struct WORLDGEN_API FClipmap
+{
+	// Append one level of a nested grid, GridResolution cells a side at CellSize * 2^level.
+	// Levels above 0 skip the centre covered by the level inside, shrunk by inset cells so levels overlap
+	static void AddLevel(int level, int gridResolution, float cellSize, int inset, TArray<FVector>& vertices, TArray<int32>& triangles, TArray<FVector>& normals);
+
+	// Snap a location to the coarsest cell of the clipmap so every level keeps its vertices still
+	static FVector Snap(FVector location, float cellSize, int levels, float z);
+
+	// Upload regions of a texture from a copy of data, both are freed once the render thread has copied them
+	static void UpdateRegions(UTexture2D* texture, const TArray<FUpdateTextureRegion2D>& regions, const void* data, int dataSize, uint32 pitch, uint32 bytesPerPixel);
+};
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FarTerrain.h"
+#include "Clipmap.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
+
+// Sets default values
+AFarTerrain::AFarTerrain()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = false;
+
+	FarMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("Far Mesh"));
+	FarMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	FarMesh->SetCastShadow(false);
+	SetRootComponent(FarMesh);
+}
+
+// Called when the game starts or when spawned
+void AFarTerrain::BeginPlay()
+{
+	Super::BeginPlay();
+}
+
+// Called every frame
+void AFarTerrain::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+}
+
+void AFarTerrain::Init(FTerrainData worldData, float cellSize, float voxelExtent)
+{
+	WorldData = worldData;
+	CellSize = cellSize;
+
+	int size = GridResolution + 1;
+	Heights.SetNum(Levels);
+	Origins.SetNum(Levels);
+
+	for (int level = 0; level < Levels; level++)
+	{
+		Heights[level].Init(0, size * size);
+
+		// Float heightmap wrapping so it can be scrolled toroidally
+		UTexture2D* heightmap = UTexture2D::CreateTransient(size, size, PF_R32_FLOAT);
+		heightmap->SRGB = false;
+		heightmap->AddressX = TA_Wrap;
+		heightmap->AddressY = TA_Wrap;
+		heightmap->Filter = TF_Bilinear;
+		heightmap->UpdateResource();
+		Heightmaps.Add(heightmap);
+
+		if (Material)
+		{
+			UMaterialInstanceDynamic* instance = UMaterialInstanceDynamic::Create(Material, this);
+			instance->SetTextureParameterValue(TEXT("Heightmap"), heightmap);
+			instance->SetScalarParameterValue(TEXT("LevelCellSize"), CellSize * (1 << level));
+			instance->SetScalarParameterValue(TEXT("HeightmapSize"), size);
+			instance->SetScalarParameterValue(TEXT("VoxelExtent"), voxelExtent);
+			FarMesh->SetMaterial(level, instance);
+			MaterialInstances.Add(instance);
+		}
+	}
+
+	if (!Material)
+	{
+		// No far terrain material in the project, hide rather than draw a default material plane to the horizon
+		UE_LOG(LogTemp, Warning, TEXT("Far terrain has no material and is hidden"));
+		SetActorHiddenInGame(true);
+	}
+
+	CreateFarMesh();
+}
+
+void AFarTerrain::SetVoxelArea(FVector voxelCenter, float voxelExtent)
+{
+	for (auto instance : MaterialInstances)
+	{
+		instance->SetVectorParameterValue(TEXT("VoxelCenter"), FLinearColor(voxelCenter));
+		instance->SetScalarParameterValue(TEXT("VoxelExtent"), voxelExtent);
+	}
+}
+
+void AFarTerrain::CreateFarMesh()
+{
+	FarMesh->ClearAllMeshSections();
+
+	// Highest the surface can reach, SurfaceHeight is clamped to the voxel grid height
+	float maxHeight = WorldData.GridHeight * WorldData.Scale;
+
+	for (int level = 0; level < Levels; level++)
+	{
+		// Flat grid, heights come from the level's heightmap in the material.
+		// Leave one cell of overlap between levels to hide cracks
+		TArray<FVector> vertices;
+		TArray<int32> triangles;
+		TArray<FVector> normals;
+		FClipmap::AddLevel(level, GridResolution, CellSize, 1, vertices, triangles, normals);
+
+		// Unused vertices at the lowest and highest surface give the section bounds the height the material displaces to
+		vertices.Add(FVector(0, 0, 0));
+		vertices.Add(FVector(0, 0, maxHeight + HeightDrop));
+		normals.Add(FVector::UpVector);
+		normals.Add(FVector::UpVector);
+
+		FarMesh->CreateMeshSection(level, vertices, triangles, normals, TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), false);
+		if (MaterialInstances.IsValidIndex(level))
+		{
+			FarMesh->SetMaterial(level, MaterialInstances[level]);
+		}
+	}
+}
+
+void AFarTerrain::Follow(FVector location)
+{
+	// Nothing to draw without a material
+	if (MaterialInstances.Num() == 0)
+	{
+		return;
+	}
+
+	FVector snapped = FClipmap::Snap(location, CellSize, Levels, -HeightDrop);
+	if (Initialised && snapped == LastLocation)
+	{
+		return;
+	}
+
+	SetActorLocation(snapped);
+
+	int half = GridResolution / 2;
+	for (int level = 0; level < Levels; level++)
+	{
+		float levelCellSize = CellSize * (1 << level);
+		FIntPoint origin(FMath::RoundToInt(snapped.X / levelCellSize) - half, FMath::RoundToInt(snapped.Y / levelCellSize) - half);
+		UpdateLevel(level, origin);
+	}
+
+	LastLocation = snapped;
+	Initialised = true;
+}
+
+void AFarTerrain::UpdateLevel(int level, FIntPoint origin)
+{
+	int size = GridResolution + 1;
+	float levelCellSize = CellSize * (1 << level);
+	FIntPoint oldOrigin = Origins[level];
+	TArray<float>& heights = Heights[level];
+
+	// Recompute everything on the first update or if the window moved further than its size
+	bool full = !Initialised || FMath::Abs(origin.X - oldOrigin.X) >= size || FMath::Abs(origin.Y - oldOrigin.Y) >= size;
+
+	auto wrap = [size](int value) { return ((value % size) + size) % size; };
+	auto isNew = [&](int x, int y)
+	{
+		return full || x < oldOrigin.X || x >= oldOrigin.X + size || y < oldOrigin.Y || y >= oldOrigin.Y + size;
+	};
+
+	const FNoisePermutation& permutation = FNoisePermutation::Get(int32(WorldData.Seed));
+
+	// Only cells that scrolled into the window are evaluated
+	ParallelFor(size, [&](int32 j)
+	{
+		int y = origin.Y + j;
+		for (int i = 0; i < size; i++)
+		{
+			int x = origin.X + i;
+			if (isNew(x, y))
+			{
+				heights[wrap(y) * size + wrap(x)] = ATerrainChunk::SurfaceHeight(WorldData, permutation, x * levelCellSize, y * levelCellSize);
+			}
+		}
+	});
+
+	// One region per scrolled row and column, or the whole texture
+	TArray<FUpdateTextureRegion2D> changed;
+	if (full)
+	{
+		changed.Add(FUpdateTextureRegion2D(0, 0, 0, 0, size, size));
+	}
+	else
+	{
+		for (int x = origin.X; x < origin.X + size; x++)
+		{
+			if (x < oldOrigin.X || x >= oldOrigin.X + size)
+			{
+				changed.Add(FUpdateTextureRegion2D(wrap(x), 0, wrap(x), 0, 1, size));
+			}
+		}
+		for (int y = origin.Y; y < origin.Y + size; y++)
+		{
+			if (y < oldOrigin.Y || y >= oldOrigin.Y + size)
+			{
+				changed.Add(FUpdateTextureRegion2D(0, wrap(y), 0, wrap(y), size, 1));
+			}
+		}
+	}
+
+	Origins[level] = origin;
+
+	FClipmap::UpdateRegions(Heightmaps[level], changed, heights.GetData(), heights.Num() * sizeof(float), size * sizeof(float), sizeof(float));
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ProceduralMeshComponent.h"
+#include "TerrainChunk.h"
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FarTerrain.generated.h"
+
+// Surface-only terrain rendered past RenderDistance as a nested clipmap.
+// Each level is a mesh section with its own heightmap texture, updated toroidally as the player moves.
+// The material displaces vertices with UV = (WorldXY / LevelCellSize + 0.5) / (GridResolution + 1)
+// and masks out pixels inside VoxelExtent of VoxelCenter, where the voxel chunks take over.
+// Without a material the far terrain is hidden.
+UCLASS()
+class WORLDGEN_API AFarTerrain : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	// Sets default values for this actor's properties
+	AFarTerrain();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Set the terrain parameters, level 0 cell size and the half size of the voxel area
+	void Init(FTerrainData worldData, float cellSize, float voxelExtent);
+
+	// Set the centre and half size of the voxel area masked out of the far terrain
+	void SetVoxelArea(FVector voxelCenter, float voxelExtent);
+
+	// Build one mesh section per clipmap level
+	void CreateFarMesh();
+
+	// Move the clipmap to follow a location and update the heightmaps that scrolled
+	void Follow(FVector location);
+
+	// Compute heights that entered a level's window and upload them
+	void UpdateLevel(int level, FIntPoint origin);
+
+	UPROPERTY(EditAnywhere)
+	UProceduralMeshComponent* FarMesh;
+
+	// Far terrain material, should read the Heightmap texture parameter
+	UPROPERTY(EditAnywhere)
+	UMaterialInterface* Material;
+
+	UPROPERTY()
+	TArray<UMaterialInstanceDynamic*> MaterialInstances;
+
+	// Surface height per level, wrapped toroidally
+	UPROPERTY(VisibleAnywhere)
+	TArray<UTexture2D*> Heightmaps;
+
+	// Cells along each side of a clipmap level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Far Terrain")
+	int GridResolution = 64;
+
+	// Number of nested levels, each double the cell size of the last
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Far Terrain")
+	int Levels = 4;
+
+	// Distance the far terrain sits below the voxel terrain so it never shows through
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Far Terrain")
+	float HeightDrop = 20;
+
+	// Cell size of the innermost level
+	float CellSize = 256;
+
+	FTerrainData WorldData;
+
+	// Heights on the CPU for each level
+	TArray<TArray<float>> Heights;
+
+	// Window origin in cells for each level
+	TArray<FIntPoint> Origins;
+
+	// Snapped location the clipmap was last updated at
+	FVector LastLocation;
+
+	bool Initialised = false;
+};
@@ -0,0 +1,157 @@
+#include "QualityGovernor.h"
+#include "RenderCore.h"
+
+void FQualityGovernor::Init(const FGovernorSettings& settings, int renderDistance, int nearRingDistance)
+{
+	Settings = settings;
+	RenderDistance = FMath::Clamp(renderDistance, Settings.MinRenderDistance, Settings.MaxRenderDistance);
+	NearRingDistance = FMath::Clamp(nearRingDistance, FMath::CeilToInt(RenderDistance * Settings.MinNearRingFraction), FMath::FloorToInt(RenderDistance * Settings.MaxNearRingFraction));
+
+	// Start with a worker per four cores, leaving the rest to the game and render threads
+	WorkerCount = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 4, Settings.MinWorkers, Settings.MaxWorkers);
+}
+
+void FQualityGovernor::Record(float deltaTime, int chunksCompleted, bool generating)
+{
+	Elapsed += deltaTime;
+	if (generating)
+	{
+		GeneratingTime += deltaTime;
+	}
+
+	// Busiest of the game and render threads, delta time includes waiting for vsync
+	FrameTimeTotal += FMath::Max(FPlatformTime::ToMilliseconds(GGameThreadTime), FPlatformTime::ToMilliseconds(GRenderThreadTime));
+	Frames++;
+	ChunksCompleted += chunksCompleted;
+}
+
+bool FQualityGovernor::Evaluate(int queueDepth, int64 meshBytes)
+{
+	if (!Settings.Enabled || Frames == 0 || Elapsed < Settings.EvaluateInterval)
+	{
+		return false;
+	}
+
+	// Average over the interval
+	FrameTimeMS = FrameTimeTotal / Frames;
+	// Keep the last throughput while idle, nothing finishing then says nothing about the rate
+	if (GeneratingTime > 0)
+	{
+		ChunksPerSecond = ChunksCompleted / GeneratingTime;
+	}
+	QueueDepth = queueDepth;
+	MeshBytes = meshBytes;
+
+	Elapsed = 0;
+	Frames = 0;
+	FrameTimeTotal = 0;
+	ChunksCompleted = 0;
+	GeneratingTime = 0;
+
+	if (CooldownLeft > 0)
+	{
+		CooldownLeft--;
+		return false;
+	}
+
+	float memoryMB = MeshBytes / (1024.0f * 1024.0f);
+	bool overMemory = memoryMB > Settings.MemoryBudgetMB;
+	bool overFrameTime = FrameTimeMS > Settings.TargetFrameTimeMS;
+	bool fallingBehind = QueueDepth > Settings.MaxQueueDepth;
+
+	// Only raise quality with headroom under every budget, so it does not flip back next evaluation
+	float headroom = 1.0f - Settings.Hysteresis;
+	bool underMemory = memoryMB < Settings.MemoryBudgetMB * headroom;
+	bool underFrameTime = FrameTimeMS < Settings.TargetFrameTimeMS * headroom;
+
+	bool changed = false;
+	if (overMemory || overFrameTime)
+	{
+		changed = Decrease(overMemory, overFrameTime);
+	}
+	else if (underMemory && underFrameTime)
+	{
+		changed = Increase(fallingBehind);
+	}
+
+	if (changed)
+	{
+		CooldownLeft = Settings.Cooldown;
+		UE_LOG(LogTemp, Log, TEXT("Quality governor: RenderDistance %d NearRing %d Workers %d (%.1f ms, %.1f chunks/s, queue %d, %.0f MB)"),
+			RenderDistance, NearRingDistance, WorkerCount, FrameTimeMS, ChunksPerSecond, QueueDepth, memoryMB);
+	}
+	return changed;
+}
+
+bool FQualityGovernor::Decrease(bool overMemory, bool overFrameTime)
+{
+	// Workers compete with the game thread for cores
+	if (overFrameTime && WorkerCount > Settings.MinWorkers)
+	{
+		WorkerCount--;
+		return true;
+	}
+
+	// Existing tiles keep their LOD, so only dropping tiles off the edge frees memory
+	if (overMemory && RenderDistance > Settings.MinRenderDistance)
+	{
+		RenderDistance--;
+		NearRingDistance = FMath::Max(FMath::CeilToInt(RenderDistance * Settings.MinNearRingFraction), FMath::Min(NearRingDistance, RenderDistance));
+		return true;
+	}
+
+	// Shrink the near ring first, it costs the most per chunk
+	int minNearRing = FMath::CeilToInt(RenderDistance * Settings.MinNearRingFraction);
+	if (NearRingDistance > minNearRing)
+	{
+		NearRingDistance--;
+		return true;
+	}
+
+	if (RenderDistance > Settings.MinRenderDistance)
+	{
+		RenderDistance--;
+		NearRingDistance = FMath::Max(FMath::CeilToInt(RenderDistance * Settings.MinNearRingFraction), FMath::Min(NearRingDistance, RenderDistance));
+		return true;
+	}
+
+	return false;
+}
+
+bool FQualityGovernor::Increase(bool fallingBehind)
+{
+	// Add workers while generation cannot keep up, before asking it for more
+	if (fallingBehind)
+	{
+		if (WorkerCount < Settings.MaxWorkers)
+		{
+			WorkerCount++;
+			return true;
+		}
+		return false;
+	}
+
+	// Only add an edge ring generation can fill in time, its side grows from 2 * RenderDistance tiles by two
+	int ringChunks = 8 * RenderDistance + 4;
+	if (RenderDistance < Settings.MaxRenderDistance && ChunksPerSecond * Settings.MaxRingFillSeconds >= ringChunks)
+	{
+		RenderDistance++;
+		return true;
+	}
+
+	// Too slow to grow, a worker may bring the rate up by the next evaluation
+	if (RenderDistance < Settings.MaxRenderDistance && WorkerCount < Settings.MaxWorkers)
+	{
+		WorkerCount++;
+		return true;
+	}
+
+	int maxNearRing = FMath::FloorToInt(RenderDistance * Settings.MaxNearRingFraction);
+	if (NearRingDistance < maxNearRing)
+	{
+		NearRingDistance++;
+		return true;
+	}
+
+	return false;
+}
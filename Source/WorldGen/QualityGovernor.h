@@ -0,0 +1,104 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "QualityGovernor.generated.h"
+
+// Limits the quality governor keeps the generator within
+USTRUCT(BlueprintType) struct FGovernorSettings
+{
+	GENERATED_BODY()
+
+	// Adjust quality at runtime, otherwise the editor values are used as they are
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool Enabled = false;
+
+	// Largest defaults to the generator's own render distance so enabling the governor never raises it unasked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MinRenderDistance = 6;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MaxRenderDistance = 18;
+
+	// Smallest and largest near LOD ring as a fraction of the render distance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinNearRingFraction = 0.15f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxNearRingFraction = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MinWorkers = 1;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MaxWorkers = 8;
+
+	// Memory allowed for chunk meshes in megabytes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MemoryBudgetMB = 512;
+
+	// Game or render thread time to stay under in milliseconds, excluding vsync and frame limiter waits
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TargetFrameTimeMS = 16.6f;
+
+	// Chunks waiting for generation or upload before generation counts as falling behind
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MaxQueueDepth = 64;
+
+	// Longest generation may take to fill the new edge ring before render distance is raised
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxRingFillSeconds = 4.0f;
+
+	// Fraction below a budget that must be free before quality is raised again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Hysteresis = 0.2f;
+
+	// Seconds between evaluations
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float EvaluateInterval = 1.0f;
+
+	// Evaluations to wait after a change before changing again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int Cooldown = 3;
+};
+
+// Measures generation throughput, queue depth, mesh memory and frame time
+// and steps render distance, LOD ring size and worker count within the configured limits
+class WORLDGEN_API FQualityGovernor
+{
+public:
+	// Start from the editor values clamped into the limits
+	void Init(const FGovernorSettings& settings, int renderDistance, int nearRingDistance);
+
+	// Record a frame and the chunks that finished during it, thread times are read from the engine.
+	// Throughput is only measured over frames where generation had work
+	void Record(float deltaTime, int chunksCompleted, bool generating);
+
+	// Evaluate the measurements, returns true if quality changed
+	bool Evaluate(int queueDepth, int64 meshBytes);
+
+	FGovernorSettings Settings;
+
+	// Current quality
+	int RenderDistance = 0;
+	int NearRingDistance = 0;
+	int WorkerCount = 1;
+
+	// Last measurements
+	float FrameTimeMS = 0;
+	float ChunksPerSecond = 0;
+	int QueueDepth = 0;
+	int64 MeshBytes = 0;
+
+private:
+	// Step quality down, returns false if already at the limits
+	bool Decrease(bool overMemory, bool overFrameTime);
+
+	// Step quality up, returns false if already at the limits
+	bool Increase(bool fallingBehind);
+
+	// Time and frames since the last evaluation
+	float Elapsed = 0;
+	int Frames = 0;
+	float FrameTimeTotal = 0;
+	int ChunksCompleted = 0;
+	float GeneratingTime = 0;
+
+	// Evaluations left before quality can change again
+	int CooldownLeft = 0;
+};
@@ -0,0 +1,108 @@
+#include "SuperChunk.h"
+#include "Async/Async.h"
+
+FSuperChunk::FSuperChunk(UProceduralMeshComponent* mesh)
+{
+	Mesh = mesh;
+}
+
+void FSuperChunk::AddMember(ATerrainChunk* chunk)
+{
+	auto data = MakeShared<FChunkMeshData, ESPMode::ThreadSafe>();
+	data->Offset = chunk->GetActorLocation() - Mesh->GetComponentLocation();
+	data->Vertices = MoveTemp(chunk->Vertices);
+	data->Triangles = MoveTemp(chunk->Triangles);
+	data->Normals = MoveTemp(chunk->Normals);
+
+	Material = chunk->Material;
+	Members.Add(chunk, data);
+	Dirty = true;
+}
+
+void FSuperChunk::RemoveMember(ATerrainChunk* chunk, bool returnMesh)
+{
+	auto data = Members.Find(chunk);
+	if (!data)
+	{
+		return;
+	}
+
+	// Copy rather than move, a running build may still be reading the data
+	if (returnMesh)
+	{
+		chunk->Vertices = (*data)->Vertices;
+		chunk->Triangles = (*data)->Triangles;
+		chunk->Normals = (*data)->Normals;
+	}
+
+	Members.Remove(chunk);
+	Dirty = true;
+}
+
+void FSuperChunk::Update()
+{
+	// Apply the finished build
+	if (Build.IsValid() && Build.IsReady())
+	{
+		const FSuperChunkMeshData& merged = Build.Get();
+		if (merged.Vertices.Num() > 0)
+		{
+			Mesh->CreateMeshSection(0, merged.Vertices, merged.Triangles, merged.Normals, TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), false);
+			Mesh->SetMaterial(0, Material);
+		}
+		else
+		{
+			Mesh->ClearAllMeshSections();
+		}
+		Build.Reset();
+	}
+
+	// Only one build at a time, later changes wait for the next one
+	if (!Dirty || Build.IsValid())
+	{
+		return;
+	}
+
+	// Builds hold their own references so members can be removed while running
+	TArray<TSharedPtr<const FChunkMeshData, ESPMode::ThreadSafe>> members;
+	Members.GenerateValueArray(members);
+	Dirty = false;
+
+	Build = Async(EAsyncExecution::ThreadPool, [members = MoveTemp(members)]()
+	{
+		FSuperChunkMeshData merged;
+
+		int numVerts = 0;
+		int numIndices = 0;
+		for (auto& member : members)
+		{
+			numVerts += member->Vertices.Num();
+			numIndices += member->Triangles.Num();
+		}
+		merged.Vertices.Reserve(numVerts);
+		merged.Normals.Reserve(numVerts);
+		merged.Triangles.Reserve(numIndices);
+
+		// Append each member offset into super chunk space
+		for (auto& member : members)
+		{
+			int firstVertex = merged.Vertices.Num();
+			for (auto& vertex : member->Vertices)
+			{
+				merged.Vertices.Add(vertex + member->Offset);
+			}
+			merged.Normals.Append(member->Normals);
+			for (auto index : member->Triangles)
+			{
+				merged.Triangles.Add(firstVertex + index);
+			}
+		}
+
+		return merged;
+	});
+}
+
+bool FSuperChunk::IsEmpty() const
+{
+	return Members.Num() == 0 && !Dirty && !Build.IsValid();
+}
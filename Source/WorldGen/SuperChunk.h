@@ -0,0 +1,59 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "ProceduralMeshComponent.h"
+#include "TerrainChunk.h"
+
+// Mesh data of one chunk, shared with super chunk builds running on other threads
+struct FChunkMeshData
+{
+	// Chunk location relative to the super chunk
+	FVector Offset;
+
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+};
+
+// Merged mesh of every member of a super chunk
+struct FSuperChunkMeshData
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+};
+
+// Group of distant chunks drawn by a single mesh component, rebuilt off the game thread when a member changes
+class WORLDGEN_API FSuperChunk
+{
+public:
+	// Constructor taking the component to draw the merged mesh with
+	FSuperChunk(UProceduralMeshComponent* mesh);
+
+	// Take a copy of a chunk's mesh data and mark for rebuild
+	void AddMember(ATerrainChunk* chunk);
+
+	// Drop a chunk's mesh data and mark for rebuild, optionally copying it back to the chunk first
+	void RemoveMember(ATerrainChunk* chunk, bool returnMesh = false);
+
+	// Apply a finished build and start a new one if members changed
+	void Update();
+
+	// True when there are no members and nothing left to build
+	bool IsEmpty() const;
+
+	// Component drawing the merged mesh
+	UProceduralMeshComponent* Mesh;
+
+	// Material applied to the merged mesh
+	UMaterialInterface* Material = nullptr;
+
+	// Mesh data of each member chunk
+	TMap<ATerrainChunk*, TSharedPtr<const FChunkMeshData, ESPMode::ThreadSafe>> Members;
+
+	// Members changed since the last build started
+	bool Dirty = false;
+
+	// Build running on the thread pool
+	TFuture<FSuperChunkMeshData> Build;
+};
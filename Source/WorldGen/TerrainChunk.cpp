@@ -3,23 +3,11 @@
 #include "TerrainChunk.h"
 #include "Generators/MarchingCubes.h"
 
-static double Seed;
-static int Octaves;
-static float SurfaceFrequency;
-static float CaveFrequency;
-static int NoiseScale;
-static int SurfaceLevel;
-static int CaveLevel;
-static int OverallNoiseScale;
-static int SurfaceNoiseScale;
-static bool GenerateCaves;
-static int CaveNoiseScale;
-
 // Sets default values
 ATerrainChunk::ATerrainChunk()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Tiles do nothing per frame, the generator drives them
+	PrimaryActorTick.bCanEverTick = false;
 
 	TerrainMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("Procedural Mesh"));
 	SetRootComponent(TerrainMesh);
@@ -50,18 +38,10 @@ void ATerrainChunk::Init(FTerrainData worldData)
 
 void ATerrainChunk::GenerateTerrainData()
 {
-	// Assign static variables
-	Seed = WorldData.Seed;
-	Octaves = WorldData.Octaves;
-	SurfaceFrequency = WorldData.SurfaceFrequency;
-	CaveFrequency = WorldData.CaveFrequency;
-	NoiseScale = WorldData.NoiseScale;
-	SurfaceLevel = WorldData.SurfaceLevel;
-	CaveLevel = WorldData.CaveLevel;
-	OverallNoiseScale = WorldData.OverallNoiseScale;
-	SurfaceNoiseScale = WorldData.SurfaceNoiseScale;
-	GenerateCaves = WorldData.GenerateCaves;
-	CaveNoiseScale = WorldData.CaveNoiseScale;
+	// Noise kernels for the octaves evaluated at every sample
+	Permutation = &FNoisePermutation::Get(int32(WorldData.Seed));
+	SurfaceHighNoise = TerrainNoise::GetFBM<2>(WorldData.SurfaceSplitOctave, WorldData.Octaves);
+	CaveHighNoise = TerrainNoise::GetFBM<3>(WorldData.CaveSplitOctave, WorldData.Octaves);
 
 	// Create bounding box to run marching cubes inside
 	UE::Geometry::FAxisAlignedBox3d boundingBox(FVector3d(GetActorLocation() / WorldData.Scale) - (FVector3d{ WorldData.GridSize, WorldData.GridSize, 0 } / 2),
@@ -69,12 +49,46 @@ void ATerrainChunk::GenerateTerrainData()
 
 	if (GetActorLocation() == FVector{ -256,0,0 })
 	{
-		CaveLevel = 9;
+		WorldData.CaveLevel = 9;
+	}
+
+	// Sample the low octaves on a coarse lattice covering the bounds plus a cube of margin,
+	// snapped outwards to a world grid of CoarseSpacing so neighbouring tiles share nodes and agree at their seams
+	double spacing = WorldData.CoarseSpacing;
+	auto snapMin = [spacing](FVector3d v) { return FVector3d(FMath::FloorToDouble(v.X / spacing), FMath::FloorToDouble(v.Y / spacing), FMath::FloorToDouble(v.Z / spacing)) * spacing; };
+	auto snapMax = [spacing](FVector3d v) { return FVector3d(FMath::CeilToDouble(v.X / spacing), FMath::CeilToDouble(v.Y / spacing), FMath::CeilToDouble(v.Z / spacing)) * spacing; };
+
+	FVector3d margin(WorldData.CubeSize, WorldData.CubeSize, WorldData.CubeSize);
+	FVector3d latticeMin = snapMin(boundingBox.Min - margin);
+	FVector3d latticeMax = snapMax(boundingBox.Max + margin);
+
+	auto surfaceLowNoise = TerrainNoise::GetFBM<2>(0, WorldData.SurfaceSplitOctave);
+	SurfaceLattice.Build(FVector(latticeMin.X, latticeMin.Y, 0), FVector(latticeMax.X, latticeMax.Y, 0), WorldData.CoarseSpacing,
+		[&](const FVector& position)
+		{
+			return surfaceLowNoise(*Permutation, SurfaceNoiseInput(position), WorldData.SurfaceFrequency);
+		});
+
+	// Without caves the cave noise is only used in the blend below the surface level
+	if (!WorldData.GenerateCaves)
+	{
+		latticeMin.Z = FMath::Max(latticeMin.Z, double(WorldData.CaveLevel - WorldData.CubeSize));
+		latticeMax.Z = FMath::Min(latticeMax.Z, double(WorldData.SurfaceLevel + WorldData.CubeSize));
+		latticeMax.Z = FMath::Max(latticeMin.Z, latticeMax.Z);
+		latticeMin = snapMin(latticeMin);
+		latticeMax = snapMax(latticeMax);
 	}
 
+	auto caveLowNoise = TerrainNoise::GetFBM<3>(0, WorldData.CaveSplitOctave);
+	CaveLattice.Build(latticeMin, latticeMax, WorldData.CoarseSpacing,
+		[&](const FVector& position)
+		{
+			return caveLowNoise(*Permutation, CaveNoiseInput(position), WorldData.CaveFrequency);
+		});
+
 	std::unique_ptr<UE::Geometry::FMarchingCubes> marchingCubes = std::make_unique<UE::Geometry::FMarchingCubes>();
 	marchingCubes->Bounds = boundingBox;
-	marchingCubes->Implicit = ATerrainChunk::PerlinWrapper; // Function to evaluate for density values
+	marchingCubes->Implicit = [this](UE::Math::TVector<double> perlinInput) { return PerlinWrapper(perlinInput); }; // Function to evaluate for density values
 	marchingCubes->bParallelCompute = true;
 
 	// DEBUG
@@ -89,6 +103,10 @@ void ATerrainChunk::GenerateTerrainData()
 	marchingCubes->IsoValue = 0;
 	marchingCubes->Generate();
 
+	// Lattices are only needed while sampling
+	SurfaceLattice.Values.Empty();
+	CaveLattice.Values.Empty();
+
 
 
 	auto numVerts = marchingCubes->Vertices.Num();
@@ -116,24 +134,46 @@ void ATerrainChunk::GenerateTerrainData()
 
 		Normals = CalculateNormals(Vertices,Triangles);
 	}
+
+	// CPU arrays plus the copy held by the mesh section
+	MeshBytes = int64(numVerts) * (sizeof(FVector) * 2 + sizeof(FProcMeshVertex)) + int64(Triangles.Num()) * sizeof(int32) * 2;
+
+	GenerateScatterData();
+	GenerateShorelineMask();
+
+	DataGenerated = true;
 }
 
-double ATerrainChunk::PerlinWrapper(UE::Math::TVector<double> perlinInput)
+FVector ATerrainChunk::SurfaceNoiseInput(const FVector& perlinInput) const
+{
+	FVector3d noiseInput = perlinInput / WorldData.NoiseScale;
+	return FVector(noiseInput.X / WorldData.SurfaceNoiseScale, noiseInput.Y / WorldData.SurfaceNoiseScale, 0);
+}
+
+FVector ATerrainChunk::CaveNoiseInput(const FVector& perlinInput) const
+{
+	return perlinInput / WorldData.NoiseScale / WorldData.CaveNoiseScale;
+}
+
+double ATerrainChunk::PerlinWrapper(UE::Math::TVector<double> perlinInput) const
 {
 	// Scale noise input
-	FVector3d noiseInput = (perlinInput + FVector{ Seed, Seed,0 }) / NoiseScale;
+	FVector3d noiseInput = perlinInput / WorldData.NoiseScale;
 
 	// Divide the world to create surface
-	float density = (-noiseInput.Z / OverallNoiseScale) + 1;
+	float density = (-noiseInput.Z / WorldData.OverallNoiseScale) + 1;
 
-	// Sample 2D noise for surface
-	density += FractalBrownianMotion(FVector(noiseInput.X / SurfaceNoiseScale, noiseInput.Y / SurfaceNoiseScale, 0), Octaves, SurfaceFrequency);
+	// Sample 2D noise for surface, low octaves interpolated from the lattice
+	density += SurfaceLattice.Sample(perlinInput) + SurfaceHighNoise(*Permutation, SurfaceNoiseInput(perlinInput), WorldData.SurfaceFrequency);
 
-	// Sample 3D noise for caves
-	float density2 = FractalBrownianMotion(FVector(noiseInput / CaveNoiseScale), Octaves, CaveFrequency);
+	// Sample 3D noise for caves, only where it is used
+	auto caveDensity = [&]()
+	{
+		return CaveLattice.Sample(perlinInput) + CaveHighNoise(*Permutation, CaveNoiseInput(perlinInput), WorldData.CaveFrequency);
+	};
 
 	// If caves should be generated
-	if (GenerateCaves)
+	if (WorldData.GenerateCaves)
 	{
 		if (perlinInput.Z < 1)//Cave floors
 		{
@@ -142,64 +182,176 @@ double ATerrainChunk::PerlinWrapper(UE::Math::TVector<double> perlinInput)
 
 		// Lerp between surface density and cave density based on the Z value
 		// Surface level and Cave level set in editor to allow customisation
-		if (perlinInput.Z >= SurfaceLevel)
+		if (perlinInput.Z >= WorldData.SurfaceLevel)
 		{
 			return density;
 		}
-		else if (perlinInput.Z < CaveLevel)
+		else if (perlinInput.Z < WorldData.CaveLevel)
 		{
-			return density2;
+			return caveDensity();
 		}
 		else
 		{
 			// Boost cave density value slightly during lerp to partially fill holes
-			return FMath::Lerp(density2 + 0.2f, density, (perlinInput.Z - CaveLevel) / (SurfaceLevel - CaveLevel));
+			return FMath::Lerp(caveDensity() + 0.2f, density, (perlinInput.Z - WorldData.CaveLevel) / (WorldData.SurfaceLevel - WorldData.CaveLevel));
 		}
 
 	}
 	else
 	{
 		// Cave floors 
-		if (perlinInput.Z == CaveLevel)
+		if (perlinInput.Z == WorldData.CaveLevel)
 		{
 			return 1;
 		}
 
 		// Return lerped values but return -1 below lerp area 
 		// This disables caves but keeps surface blend interesting
-		if (perlinInput.Z >= SurfaceLevel)
+		if (perlinInput.Z >= WorldData.SurfaceLevel)
 		{
 			return density;
 		}
-		else if (perlinInput.Z < CaveLevel)
+		else if (perlinInput.Z < WorldData.CaveLevel)
 		{
 			return -1;
 		}
 		else
 		{
-			return FMath::Lerp(density2 + 0.1f, density, (perlinInput.Z - CaveLevel) / (SurfaceLevel - CaveLevel));
+			return FMath::Lerp(caveDensity() + 0.1f, density, (perlinInput.Z - WorldData.CaveLevel) / (WorldData.SurfaceLevel - WorldData.CaveLevel));
 		}
 	}
 
 	return 1;
 }
 
-float ATerrainChunk::FractalBrownianMotion(FVector fractalInput, float octaves, float frequency)
+float ATerrainChunk::SurfaceHeight(const FTerrainData& worldData, const FNoisePermutation& permutation, double x, double y)
 {
-	float result = 0;
-	float amplitude = 0.5;
-	float lacunarity = 2.0;
-	float gain = 0.5;
+	// Same scaling as PerlinWrapper
+	FVector2D noiseInput = FVector2D(x, y) / worldData.Scale / worldData.NoiseScale;
+	float noise = TerrainNoise::GetFBM<2>(worldData.Octaves)(permutation, FVector(noiseInput.X / worldData.SurfaceNoiseScale, noiseInput.Y / worldData.SurfaceNoiseScale, 0), worldData.SurfaceFrequency);
+
+	// Solve the surface density for zero, limited to the heights marching cubes can place a surface at:
+	// density below the cave level is solid and the bounds stop at the grid height
+	float height = (noise + 1) * worldData.OverallNoiseScale * worldData.NoiseScale;
+	return FMath::Clamp(height, float(worldData.CaveLevel), worldData.GridHeight) * worldData.Scale;
+}
+
+void ATerrainChunk::GenerateScatterData()
+{
+	FVector chunkLocation = GetActorLocation();
+	ScatterTransforms.SetNum(WorldData.ScatterLayers.Num());
 
-	// Add iterations of noise at different frequencies to get more detail from perlin noise
-	for (int i = 0; i < octaves; i++)
+	for (int layer = 0; layer < WorldData.ScatterLayers.Num(); layer++)
 	{
-		result += amplitude * FMath::PerlinNoise3D(frequency * fractalInput);
-		frequency *= lacunarity;
-		amplitude *= gain;
+		const FScatterLayer& rules = WorldData.ScatterLayers[layer];
+		TArray<FTransform>& transforms = ScatterTransforms[layer];
+		transforms.Reset();
+
+		// Lowest normal Z that is still flat enough and instances per square unit
+		float minNormalZ = FMath::Cos(FMath::DegreesToRadians(rules.MaxSlope));
+		float density = rules.Density * WorldData.ScatterDensity / (100.0f * 100.0f);
+
+		for (int i = 0; i + 2 < Triangles.Num(); i += 3)
+		{
+			auto A = Vertices[Triangles[i]];
+			auto B = Vertices[Triangles[i + 1]];
+			auto C = Vertices[Triangles[i + 2]];
+
+			// Same winding as CalculateNormals
+			auto cross = (A - B) ^ (C - B);
+			float area = cross.Size() / 2;
+			auto normal = cross.GetSafeNormal();
+
+			// Skip triangles too steep for this layer
+			if (area <= 0 || normal.Z < minNormalZ)
+			{
+				continue;
+			}
+
+			// Seed from the triangle position so placement does not depend on triangle order or thread
+			FVector centroid = chunkLocation + (A + B + C) / 3;
+			uint32 hash = GetTypeHash(FIntVector(FMath::RoundToInt(centroid.X), FMath::RoundToInt(centroid.Y), FMath::RoundToInt(centroid.Z)));
+			hash = HashCombine(hash, GetTypeHash(WorldData.Seed));
+			hash = HashCombine(hash, GetTypeHash(layer));
+			FRandomStream stream(int32(hash));
+
+			// Whole instances plus a chance of one more for the remainder
+			float expected = area * density;
+			int count = FMath::FloorToInt(expected);
+			if (stream.FRand() < expected - count)
+			{
+				count++;
+			}
+
+			for (int j = 0; j < count; j++)
+			{
+				// Random point inside the triangle
+				float u = stream.FRand();
+				float v = stream.FRand();
+				if (u + v > 1)
+				{
+					u = 1 - u;
+					v = 1 - v;
+				}
+				FVector position = chunkLocation + A + (B - A) * u + (C - A) * v;
+
+				if (position.Z < rules.MinHeight || position.Z > rules.MaxHeight)
+				{
+					continue;
+				}
+
+				FQuat rotation(FVector::UpVector, stream.FRandRange(0, 2 * PI));
+				if (rules.AlignToSurface)
+				{
+					rotation = FQuat::FindBetweenNormals(FVector::UpVector, normal) * rotation;
+				}
+
+				transforms.Add(FTransform(rotation, position, FVector(stream.FRandRange(rules.MinScale, rules.MaxScale))));
+			}
+		}
+	}
+}
+
+void ATerrainChunk::GenerateShorelineMask()
+{
+	int resolution = WorldData.ShorelineResolution;
+	float chunkSize = WorldData.GridSize * WorldData.Scale;
+	float cellSize = chunkSize / resolution;
+
+	// Highest surface point in each cell
+	TArray<float> heights;
+	heights.Init(-MAX_FLT, resolution * resolution);
+
+	FVector chunkLocation = GetActorLocation();
+	for (auto& vertex : Vertices)
+	{
+		int x = FMath::Clamp(FMath::FloorToInt((vertex.X + chunkSize / 2) / cellSize), 0, resolution - 1);
+		int y = FMath::Clamp(FMath::FloorToInt((vertex.Y + chunkSize / 2) / cellSize), 0, resolution - 1);
+		auto& height = heights[y * resolution + x];
+		height = FMath::Max(height, float(chunkLocation.Z + vertex.Z));
 	}
 
-	return result;
+	// Cells coarser LODs left without vertices take the average of the rest
+	float total = 0;
+	int filled = 0;
+	for (auto height : heights)
+	{
+		if (height > -MAX_FLT)
+		{
+			total += height;
+			filled++;
+		}
+	}
+	float average = filled > 0 ? total / filled : WorldData.WaterLevel - WorldData.ShoreDepth;
+
+	// Store depth below the water level, 0 on land and at the shore, 255 in deep water
+	ShorelineMask.SetNum(heights.Num());
+	for (int i = 0; i < heights.Num(); i++)
+	{
+		float height = heights[i] > -MAX_FLT ? heights[i] : average;
+		float depth = FMath::Clamp((WorldData.WaterLevel - height) / WorldData.ShoreDepth, 0.0f, 1.0f);
+		ShorelineMask[i] = uint8(FMath::RoundToInt(depth * 255));
+	}
 }
 
 // Calculate normals on an array of vertices and indices
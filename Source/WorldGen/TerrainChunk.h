@@ -3,11 +3,47 @@
 #pragma once
 
 #include "ProceduralMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "TerrainNoise.h"
+#include <atomic>
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "TerrainChunk.generated.h"
 
+USTRUCT(BlueprintType) struct FScatterLayer
+{
+	GENERATED_BODY()
+
+	// Mesh instanced for this layer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* Mesh = nullptr;
+
+	// Average number of instances per 100x100 units of surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Density = 0.05f;
+
+	// World height range instances can be placed in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinHeight = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxHeight = 1000;
+
+	// Steepest surface in degrees instances can be placed on
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxSlope = 30;
+
+	// Random uniform scale range
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinScale = 0.8f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxScale = 1.2f;
+
+	// Tilt instances to match the surface normal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool AlignToSurface = false;
+};
+
 USTRUCT() struct FTerrainData
 {
 	GENERATED_BODY()
@@ -27,6 +63,14 @@ USTRUCT() struct FTerrainData
 	int SurfaceNoiseScale;
 	bool GenerateCaves;
 	int CaveNoiseScale;
+	float CoarseSpacing;
+	int SurfaceSplitOctave;
+	int CaveSplitOctave;
+	float ScatterDensity;
+	float WaterLevel;
+	float ShoreDepth;
+	int ShorelineResolution;
+	TArray<FScatterLayer> ScatterLayers;
 };
 
 UCLASS()
@@ -51,9 +95,20 @@ public:
 	void GenerateTerrainData();
 
 	// Implicit function to evaluate with marching cubes algorithm to generate density values
-	static double PerlinWrapper(UE::Math::TVector<double> perlinInput);
+	double PerlinWrapper(UE::Math::TVector<double> perlinInput) const;
 
-	static float FractalBrownianMotion(FVector fractalInput, float octaves, float frequency);
+	// Scale a density sample position into surface and cave noise space
+	FVector SurfaceNoiseInput(const FVector& perlinInput) const;
+	FVector CaveNoiseInput(const FVector& perlinInput) const;
+
+	// Height of the surface without caves within the range voxel tiles can produce, used by the far terrain
+	static float SurfaceHeight(const FTerrainData& worldData, const FNoisePermutation& permutation, double x, double y);
+
+	// Place scatter instances on the generated surface
+	void GenerateScatterData();
+
+	// Build the shoreline mask from the surface heights of the generated mesh
+	void GenerateShorelineMask();
 
 	TArray<FVector> CalculateNormals(TArray<FVector> vertices, TArray<int32> indices);
 
@@ -73,6 +128,15 @@ public:
 
 	FTerrainData WorldData;
 
+	// Noise table and kernels for the octaves above the split
+	const FNoisePermutation* Permutation = nullptr;
+	TerrainNoise::FFBMFunction SurfaceHighNoise = nullptr;
+	TerrainNoise::FFBMFunction CaveHighNoise = nullptr;
+
+	// Octaves below the split sampled once per lattice node
+	FNoiseLattice SurfaceLattice;
+	FNoiseLattice CaveLattice;
+
 	// Data for mesh generation
 	UPROPERTY()
 	TArray<FVector> Vertices;
@@ -87,7 +151,33 @@ public:
 	UPROPERTY()
 	TArray <FProcMeshTangent> Tangents;
 
+	// World transforms of scatter instances for each scatter layer
+	TArray<TArray<FTransform>> ScatterTransforms;
+
+	// Depth below water for each shoreline mask texel
+	TArray<uint8> ShorelineMask;
+
 	UPROPERTY()
 	bool MeshCreated = false;
 
+	// Approximate memory held by the generated and rendered mesh
+	int64 MeshBytes = 0;
+
+	// MeshBytes has been added to the generator's total
+	bool MeshBytesCounted = false;
+
+	// Spawned ahead of the player rather than inside the render area
+	UPROPERTY()
+	bool Prefetched = false;
+
+	// Generation has run and mesh data is ready to upload
+	std::atomic<bool> DataGenerated{ false };
+
+	// Set by the game thread to make the worker skip the tile
+	std::atomic<bool> Cancelled{ false };
+
+	// Drawn by a super chunk instead of its own mesh component, cleared when the player moves into the near ring
+	UPROPERTY()
+	bool Merged = false;
+
 };
@@ -0,0 +1,92 @@
+#include "TerrainNoise.h"
+#include "Misc/ScopeLock.h"
+
+FNoisePermutation::FNoisePermutation(int32 seed)
+{
+	for (int i = 0; i < 256; i++)
+	{
+		P[i] = uint8(i);
+	}
+
+	// Fisher-Yates shuffle
+	FRandomStream stream(seed);
+	for (int i = 255; i > 0; i--)
+	{
+		Swap(P[i], P[stream.RandRange(0, i)]);
+	}
+
+	for (int i = 0; i < 256; i++)
+	{
+		P[i + 256] = P[i];
+	}
+}
+
+const FNoisePermutation& FNoisePermutation::Get(int32 seed)
+{
+	static FCriticalSection CriticalSection;
+	static TMap<int32, TUniquePtr<FNoisePermutation>> Tables;
+
+	// Tables are never freed so references stay valid
+	FScopeLock lock(&CriticalSection);
+	auto& table = Tables.FindOrAdd(seed);
+	if (!table)
+	{
+		table = MakeUnique<FNoisePermutation>(seed);
+	}
+	return *table;
+}
+
+void FNoiseLattice::Build(const FVector& min, const FVector& max, double spacing, TFunctionRef<float(const FVector&)> function)
+{
+	Origin = min;
+	Spacing = spacing;
+	Count = FIntVector(FMath::CeilToInt((max.X - min.X) / spacing) + 1,
+					   FMath::CeilToInt((max.Y - min.Y) / spacing) + 1,
+					   FMath::CeilToInt((max.Z - min.Z) / spacing) + 1);
+
+	Values.SetNumUninitialized(Count.X * Count.Y * Count.Z);
+	for (int z = 0; z < Count.Z; z++)
+	{
+		for (int y = 0; y < Count.Y; y++)
+		{
+			for (int x = 0; x < Count.X; x++)
+			{
+				Values[(z * Count.Y + y) * Count.X + x] = function(Origin + FVector(x, y, z) * Spacing);
+			}
+		}
+	}
+}
+
+float FNoiseLattice::Sample(const FVector& position) const
+{
+	if (Values.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Cell and position inside it on each axis, a single layer axis always uses node 0
+	FVector local = (position - Origin) / Spacing;
+	int cell[3];
+	float t[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int count = Count[axis];
+		double value = FMath::Clamp(local[axis], 0.0, double(count - 1));
+		cell[axis] = FMath::Clamp(FMath::FloorToInt(value), 0, FMath::Max(count - 2, 0));
+		t[axis] = count > 1 ? float(value - cell[axis]) : 0;
+	}
+
+	int strideY = Count.X;
+	int strideZ = Count.X * Count.Y;
+	int stepX = Count.X > 1 ? 1 : 0;
+	int stepY = Count.Y > 1 ? strideY : 0;
+	int stepZ = Count.Z > 1 ? strideZ : 0;
+	int base = cell[2] * strideZ + cell[1] * strideY + cell[0];
+
+	float c00 = FMath::Lerp(Values[base], Values[base + stepX], t[0]);
+	float c10 = FMath::Lerp(Values[base + stepY], Values[base + stepY + stepX], t[0]);
+	float c01 = FMath::Lerp(Values[base + stepZ], Values[base + stepZ + stepX], t[0]);
+	float c11 = FMath::Lerp(Values[base + stepZ + stepY], Values[base + stepZ + stepY + stepX], t[0]);
+
+	return FMath::Lerp(FMath::Lerp(c00, c10, t[1]), FMath::Lerp(c01, c11, t[1]), t[2]);
+}
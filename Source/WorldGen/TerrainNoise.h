@@ -0,0 +1,248 @@
+#pragma once
+#include "CoreMinimal.h"
+#include <utility>
+
+// Seeded permutation table for gradient noise
+struct WORLDGEN_API FNoisePermutation
+{
+	// Shuffle 0-255 with the seed and repeat it so lookups never need wrapping
+	explicit FNoisePermutation(int32 seed);
+
+	// Returns the shared table for a seed, built on first use
+	static const FNoisePermutation& Get(int32 seed);
+
+	uint8 P[512];
+};
+
+namespace TerrainNoise
+{
+	// Gradient directions, the 12 cube edges with 4 repeated to make 16
+	inline constexpr float GradX3[16] = { 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 1, 0, -1, 0 };
+	inline constexpr float GradY3[16] = { 1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1 };
+	inline constexpr float GradZ3[16] = { 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1, 0, 1, 0, -1 };
+
+	// Gradient directions in the plane
+	inline constexpr float GradX2[8] = { 1, -1, 1, -1, 1, -1, 0, 0 };
+	inline constexpr float GradY2[8] = { 1, 1, -1, -1, 0, 0, 1, -1 };
+
+	FORCEINLINE float Fade(float t)
+	{
+		return t * t * t * (t * (t * 6 - 15) + 10);
+	}
+
+	// Gradient noise on the XY plane
+	FORCEINLINE float Perlin2D(const FNoisePermutation& permutation, double px, double py)
+	{
+		const uint8* P = permutation.P;
+
+		double fx = FMath::FloorToDouble(px);
+		double fy = FMath::FloorToDouble(py);
+		float x = float(px - fx);
+		float y = float(py - fy);
+		int X = int64(fx) & 255;
+		int Y = int64(fy) & 255;
+
+		float u = Fade(x);
+		float v = Fade(y);
+
+		int A = P[X] + Y;
+		int B = P[X + 1] + Y;
+		int AA = P[A] & 7, AB = P[A + 1] & 7, BA = P[B] & 7, BB = P[B + 1] & 7;
+
+		float n00 = GradX2[AA] * x + GradY2[AA] * y;
+		float n10 = GradX2[BA] * (x - 1) + GradY2[BA] * y;
+		float n01 = GradX2[AB] * x + GradY2[AB] * (y - 1);
+		float n11 = GradX2[BB] * (x - 1) + GradY2[BB] * (y - 1);
+
+		return FMath::Lerp(FMath::Lerp(n00, n10, u), FMath::Lerp(n01, n11, u), v);
+	}
+
+	// Improved Perlin noise in 3D
+	FORCEINLINE float Perlin3D(const FNoisePermutation& permutation, double px, double py, double pz)
+	{
+		const uint8* P = permutation.P;
+
+		double fx = FMath::FloorToDouble(px);
+		double fy = FMath::FloorToDouble(py);
+		double fz = FMath::FloorToDouble(pz);
+		float x = float(px - fx);
+		float y = float(py - fy);
+		float z = float(pz - fz);
+		int X = int64(fx) & 255;
+		int Y = int64(fy) & 255;
+		int Z = int64(fz) & 255;
+
+		float u = Fade(x);
+		float v = Fade(y);
+		float w = Fade(z);
+
+		int A = P[X] + Y, AA = P[A] + Z, AB = P[A + 1] + Z;
+		int B = P[X + 1] + Y, BA = P[B] + Z, BB = P[B + 1] + Z;
+
+		auto grad = [](int hash, float gx, float gy, float gz)
+		{
+			hash &= 15;
+			return GradX3[hash] * gx + GradY3[hash] * gy + GradZ3[hash] * gz;
+		};
+
+		return FMath::Lerp(
+			FMath::Lerp(FMath::Lerp(grad(P[AA], x, y, z), grad(P[BA], x - 1, y, z), u),
+						FMath::Lerp(grad(P[AB], x, y - 1, z), grad(P[BB], x - 1, y - 1, z), u), v),
+			FMath::Lerp(FMath::Lerp(grad(P[AA + 1], x, y, z - 1), grad(P[BA + 1], x - 1, y, z - 1), u),
+						FMath::Lerp(grad(P[AB + 1], x, y - 1, z - 1), grad(P[BB + 1], x - 1, y - 1, z - 1), u), v), w);
+	}
+
+	// Noise of the given dimensionality, 2D ignores Z
+	template<int Dimensions>
+	FORCEINLINE float Noise(const FNoisePermutation& permutation, const FVector& input)
+	{
+		static_assert(Dimensions == 2 || Dimensions == 3, "Noise is 2D or 3D");
+		if constexpr (Dimensions == 2)
+		{
+			return Perlin2D(permutation, input.X, input.Y);
+		}
+		else
+		{
+			return Perlin3D(permutation, input.X, input.Y, input.Z);
+		}
+	}
+
+	// Constants shared by the terrain's fractal noise
+	struct FDefaultFBM
+	{
+		static constexpr float Amplitude = 0.5f;
+		static constexpr float Lacunarity = 2.0f;
+		static constexpr float Gain = 0.5f;
+	};
+
+	constexpr float Power(float base, int exponent)
+	{
+		return exponent == 0 ? 1.0f : base * Power(base, exponent - 1);
+	}
+
+	// Fractal Brownian motion with the octave count, dimensionality and constants fixed at compile time,
+	// so the octave loop unrolls and every frequency and amplitude is a constant.
+	// Octaves below FirstOctave are skipped, so a low and high kernel split at the same octave sum to the full kernel
+	template<int Octaves, int Dimensions, typename TConstants = FDefaultFBM, int FirstOctave = 0>
+	struct TFBM
+	{
+		static float Evaluate(const FNoisePermutation& permutation, const FVector& input, float frequency)
+		{
+			return Sum(permutation, input, frequency, std::make_integer_sequence<int, (Octaves > FirstOctave ? Octaves - FirstOctave : 0)>());
+		}
+
+	private:
+		template<int Octave>
+		static constexpr float Amplitude = TConstants::Amplitude * Power(TConstants::Gain, Octave);
+
+		template<int Octave>
+		static constexpr float Frequency = Power(TConstants::Lacunarity, Octave);
+
+		template<int... Octave>
+		static FORCEINLINE float Sum(const FNoisePermutation& permutation, const FVector& input, float frequency, std::integer_sequence<int, Octave...>)
+		{
+			return (0.0f + ... + (Amplitude<FirstOctave + Octave> * Noise<Dimensions>(permutation, input * (frequency * Frequency<FirstOctave + Octave>))));
+		}
+	};
+
+	// Kernel selected at runtime from the compiled specializations
+	using FFBMFunction = float(*)(const FNoisePermutation& permutation, const FVector& input, float frequency);
+
+	// Highest octave count with a compiled kernel
+	constexpr int MaxOctaves = 12;
+
+	// Kernels for every first octave and octave count, indexed by firstOctave * (MaxOctaves + 1) + octaves
+	template<int Dimensions, int... Index>
+	FFBMFunction SelectFBM(int firstOctave, int octaves, std::integer_sequence<int, Index...>)
+	{
+		static constexpr FFBMFunction Kernels[] = { &TFBM<Index % (MaxOctaves + 1), Dimensions, FDefaultFBM, Index / (MaxOctaves + 1)>::Evaluate... };
+		return Kernels[FMath::Clamp(firstOctave, 0, MaxOctaves) * (MaxOctaves + 1) + FMath::Clamp(octaves, 0, MaxOctaves)];
+	}
+
+	// Returns the kernel summing octaves firstOctave to octaves - 1, clamped to MaxOctaves
+	template<int Dimensions>
+	FFBMFunction GetFBM(int firstOctave, int octaves)
+	{
+		return SelectFBM<Dimensions>(firstOctave, octaves, std::make_integer_sequence<int, (MaxOctaves + 1) * (MaxOctaves + 1)>());
+	}
+
+	// Returns the kernel for an octave count, clamped to MaxOctaves
+	template<int Dimensions>
+	FFBMFunction GetFBM(int octaves)
+	{
+		return GetFBM<Dimensions>(0, octaves);
+	}
+
+	// Largest number of low octaves that can be interpolated from a lattice with the given spacing in kernel input units,
+	// keeping the worst error measured on a dense grid of points inside random lattice cells, times a safety factor, under the tolerance
+	template<int Dimensions>
+	int PickSplitOctave(const FNoisePermutation& permutation, int octaves, float frequency, double spacing, float tolerance, int cells = 64, int steps = 8, float safety = 1.5f)
+	{
+		// Points per cell, a single layer in 2D
+		int stepsZ = Dimensions == 3 ? steps - 1 : 1;
+		int corners = Dimensions == 3 ? 8 : 4;
+
+		for (int split = FMath::Min(octaves, MaxOctaves); split > 0; split--)
+		{
+			FFBMFunction low = GetFBM<Dimensions>(0, split);
+			FRandomStream stream(split);
+			float maxError = 0;
+
+			for (int cell = 0; cell < cells && maxError * safety <= tolerance; cell++)
+			{
+				// Random lattice cell and its corner values
+				FVector corner(FMath::FloorToDouble(stream.FRandRange(-1000, 1000)) * spacing,
+							   FMath::FloorToDouble(stream.FRandRange(-1000, 1000)) * spacing,
+							   Dimensions == 3 ? FMath::FloorToDouble(stream.FRandRange(-1000, 1000)) * spacing : 0);
+				float values[8];
+				for (int c = 0; c < corners; c++)
+				{
+					values[c] = low(permutation, corner + FVector(c & 1, (c >> 1) & 1, (c >> 2) & 1) * spacing, frequency);
+				}
+
+				// Interior points of the cell on a regular grid, interpolated the same way FNoiseLattice does
+				for (int z = 0; z < stepsZ; z++)
+				{
+					for (int y = 1; y < steps; y++)
+					{
+						for (int x = 1; x < steps; x++)
+						{
+							FVector t(double(x) / steps, double(y) / steps, Dimensions == 3 ? double(z + 1) / steps : 0);
+
+							float interpolated = 0;
+							for (int c = 0; c < corners; c++)
+							{
+								FVector offset(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+								interpolated += (offset.X ? t.X : 1 - t.X) * (offset.Y ? t.Y : 1 - t.Y) * (offset.Z ? t.Z : 1 - t.Z) * values[c];
+							}
+
+							float exact = low(permutation, corner + t * spacing, frequency);
+							maxError = FMath::Max(maxError, FMath::Abs(interpolated - exact));
+						}
+					}
+				}
+			}
+
+			if (maxError * safety <= tolerance)
+			{
+				return split;
+			}
+		}
+		return 0;
+	}
+}
+
+// Values of a function on a regular grid, reconstructed between nodes by linear interpolation
+struct WORLDGEN_API FNoiseLattice
+{
+	// Evaluate the function at every node covering min to max, a single layer if min and max Z match
+	void Build(const FVector& min, const FVector& max, double spacing, TFunctionRef<float(const FVector&)> function);
+
+	// Interpolate the nodes around a position, clamped to the lattice
+	float Sample(const FVector& position) const;
+
+	FVector Origin = FVector::ZeroVector;
+	double Spacing = 1;
+	FIntVector Count = FIntVector::ZeroValue;
+	TArray<float> Values;
+};
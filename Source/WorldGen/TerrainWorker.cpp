@@ -1,4 +1,5 @@
 #include "TerrainWorker.h"
+#include "Async/ParallelFor.h"
 
 #pragma region Main Thread
 
@@ -39,16 +40,20 @@ uint32 FTerrainWorker::Run()
 			// Lock section
 			if (CriticalSection.TryLock())
 			{
-				// For each tile
-				for (auto& tile : Chunks)
+				// Split the tiles between workers, each taking every WorkerCount'th tile
+				int workers = FMath::Max(1, WorkerCount);
+				ParallelFor(workers, [this, workers](int32 worker)
 				{
-					// If mesh hasnt already been created
-					if (!tile->MeshCreated)
+					for (int i = worker; i < Chunks.Num(); i += workers)
 					{
-						// Run marching cubes and generate mesh data
-						tile->GenerateTerrainData();
+						// If mesh data hasnt already been generated and the tile is still wanted
+						if (!Chunks[i]->MeshCreated && !Chunks[i]->DataGenerated && !Chunks[i]->Cancelled)
+						{
+							// Run marching cubes and generate mesh data
+							Chunks[i]->GenerateTerrainData();
+						}
 					}
-				}
+				}, workers == 1);
 				
 				// Set work as completed
 				ThreadComplete = true;
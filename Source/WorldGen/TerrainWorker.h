@@ -30,6 +30,9 @@ public:
 	// Is thread finished working
 	bool ThreadComplete = false;
 
+	// Number of tiles generated at once, only changed between batches
+	int WorkerCount = 1;
+
 	// Array of tiles to work on
 	TArray<ATerrainChunk*> Chunks;
 
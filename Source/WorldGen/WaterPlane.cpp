@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WaterPlane.h"
+#include "Clipmap.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/Texture2D.h"
+
+// Sets default values
+AWaterPlane::AWaterPlane()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = false;
+
+	WaterMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("Water Mesh"));
+	WaterMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetRootComponent(WaterMesh);
+}
+
+// Called when the game starts or when spawned
+void AWaterPlane::BeginPlay()
+{
+	Super::BeginPlay();
+
+	CreateWaterMesh();
+}
+
+// Called every frame
+void AWaterPlane::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+}
+
+void AWaterPlane::Init(float chunkSize, int chunks, int resolution, float waterLevel)
+{
+	ShorelineChunkSize = chunkSize;
+	ShorelineChunks = chunks;
+	ShorelineResolution = resolution;
+	WaterLevel = waterLevel;
+
+	// Create the mask texture, wrapping so chunks can be written toroidally
+	int size = ShorelineChunks * ShorelineResolution;
+	ShorelineTexture = UTexture2D::CreateTransient(size, size, PF_G8);
+	ShorelineTexture->SRGB = false;
+	ShorelineTexture->AddressX = TA_Wrap;
+	ShorelineTexture->AddressY = TA_Wrap;
+	ShorelineTexture->Filter = TF_Bilinear;
+	ShorelineTexture->UpdateResource();
+
+	// Texels no tile has written yet read as deep water
+	TArray<uint8> deep;
+	deep.Init(255, size * size);
+	UploadShoreline(0, 0, size, deep);
+
+	if (Material)
+	{
+		MaterialInstance = UMaterialInstanceDynamic::Create(Material, this);
+		MaterialInstance->SetTextureParameterValue(TEXT("ShorelineMask"), ShorelineTexture);
+		MaterialInstance->SetScalarParameterValue(TEXT("ShorelineChunkSize"), ShorelineChunkSize);
+		MaterialInstance->SetScalarParameterValue(TEXT("ShorelineChunks"), ShorelineChunks);
+		WaterMesh->SetMaterial(0, MaterialInstance);
+	}
+	else
+	{
+		// No water material in the project, hide rather than draw a default material plane through the terrain
+		UE_LOG(LogTemp, Warning, TEXT("Water has no material and is hidden"));
+		SetActorHiddenInGame(true);
+	}
+}
+
+void AWaterPlane::CreateWaterMesh()
+{
+	TArray<FVector> vertices;
+	TArray<int32> triangles;
+	TArray<FVector> normals;
+	for (int level = 0; level < Levels; level++)
+	{
+		FClipmap::AddLevel(level, GridResolution, CellSize, 0, vertices, triangles, normals);
+	}
+
+	// Texture coordinates in innermost cells
+	TArray<FVector2D> uv0;
+	for (auto& vertex : vertices)
+	{
+		uv0.Add(FVector2D(vertex.X, vertex.Y) / CellSize);
+	}
+
+	// The mesh is flat so T junctions between levels do not open cracks
+	WaterMesh->ClearAllMeshSections();
+	WaterMesh->CreateMeshSection(0, vertices, triangles, normals, uv0, TArray<FColor>(), TArray<FProcMeshTangent>(), false);
+	if (MaterialInstance)
+	{
+		WaterMesh->SetMaterial(0, MaterialInstance);
+	}
+}
+
+void AWaterPlane::Follow(FVector location)
+{
+	SetActorLocation(FClipmap::Snap(location, CellSize, Levels, WaterLevel));
+}
+
+void AWaterPlane::UpdateShoreline(FVector chunkLocation, const TArray<uint8>& mask)
+{
+	if (!ShorelineTexture || mask.Num() != ShorelineResolution * ShorelineResolution)
+	{
+		return;
+	}
+
+	// Chunk grid position wrapped into the texture
+	int chunkX = FMath::RoundToInt(chunkLocation.X / ShorelineChunkSize);
+	int chunkY = FMath::RoundToInt(chunkLocation.Y / ShorelineChunkSize);
+	chunkX = ((chunkX % ShorelineChunks) + ShorelineChunks) % ShorelineChunks;
+	chunkY = ((chunkY % ShorelineChunks) + ShorelineChunks) % ShorelineChunks;
+
+	UploadShoreline(chunkX * ShorelineResolution, chunkY * ShorelineResolution, ShorelineResolution, mask);
+}
+
+void AWaterPlane::ClearShoreline(FVector chunkLocation)
+{
+	TArray<uint8> deep;
+	deep.Init(255, ShorelineResolution * ShorelineResolution);
+	UpdateShoreline(chunkLocation, deep);
+}
+
+void AWaterPlane::SetShorelineWindow(FVector center, float extent)
+{
+	if (MaterialInstance)
+	{
+		MaterialInstance->SetVectorParameterValue(TEXT("ShorelineCenter"), FLinearColor(center));
+		MaterialInstance->SetScalarParameterValue(TEXT("ShorelineExtent"), extent);
+	}
+}
+
+void AWaterPlane::UploadShoreline(int x, int y, int size, const TArray<uint8>& data)
+{
+	FClipmap::UpdateRegions(ShorelineTexture, { FUpdateTextureRegion2D(x, y, 0, 0, size, size) }, data.GetData(), data.Num(), size, 1);
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ProceduralMeshComponent.h"
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WaterPlane.generated.h"
+
+// Camera centred water clipmap. The mesh is built once and follows the player,
+// shorelines are written into a toroidal mask texture as chunks finish generating.
+// The material samples the mask with UV = (WorldXY / ShorelineChunkSize + 0.5) / ShorelineChunks,
+// and treats pixels outside ShorelineCenter +- ShorelineExtent as deep water since the mask only holds generated tiles.
+// Without a material the water is hidden.
+UCLASS()
+class WORLDGEN_API AWaterPlane : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	// Sets default values for this actor's properties
+	AWaterPlane();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Set the chunk size and number of chunks the shoreline mask covers
+	void Init(float chunkSize, int chunks, int resolution, float waterLevel);
+
+	// Build the nested clipmap grid
+	void CreateWaterMesh();
+
+	// Move the clipmap to follow a location, snapped to the coarsest cell to keep vertices still
+	void Follow(FVector location);
+
+	// Write a chunk's shoreline mask into the mask texture
+	void UpdateShoreline(FVector chunkLocation, const TArray<uint8>& mask);
+
+	// Reset a removed chunk's texels to deep water
+	void ClearShoreline(FVector chunkLocation);
+
+	// Set the area of generated tiles the shoreline mask is valid in
+	void SetShorelineWindow(FVector center, float extent);
+
+	// Upload a square block of the shoreline mask
+	void UploadShoreline(int x, int y, int size, const TArray<uint8>& data);
+
+	UPROPERTY(EditAnywhere)
+	UProceduralMeshComponent* WaterMesh;
+
+	// Water material, should read the ShorelineMask texture parameter
+	UPROPERTY(EditAnywhere)
+	UMaterialInterface* Material;
+
+	UPROPERTY()
+	UMaterialInstanceDynamic* MaterialInstance;
+
+	// Depth below water per texel, 0 at the shoreline and 255 in deep water
+	UPROPERTY(VisibleAnywhere)
+	UTexture2D* ShorelineTexture;
+
+	// Cells along each side of a clipmap level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	int GridResolution = 32;
+
+	// Number of nested levels, each double the cell size of the last
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	int Levels = 6;
+
+	// Cell size of the innermost level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float CellSize = 64;
+
+	// World height of the water surface
+	float WaterLevel = 0;
+
+	// World size of a chunk in the shoreline mask
+	float ShorelineChunkSize = 256;
+
+	// Chunks along each side of the shoreline mask
+	int ShorelineChunks = 0;
+
+	// Texels along each side of a chunk in the shoreline mask
+	int ShorelineResolution = 0;
+};
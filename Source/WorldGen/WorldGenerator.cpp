@@ -9,6 +9,7 @@ AWorldGenerator::AWorldGenerator()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 }
 
 // Called when the game starts or when spawned
@@ -31,12 +32,73 @@ void AWorldGenerator::BeginPlay()
 	WorldData.SurfaceNoiseScale = 12;
 	WorldData.GenerateCaves = false;
 	WorldData.CaveNoiseScale = 6;
+	WorldData.ScatterDensity = NearScatterDensity;
+	WorldData.ScatterLayers = ScatterLayers;
+
+	// Pick how many low octaves come from each chunk's coarse lattice
+	// Spacing can still be set to zero from blueprints, the lattice divides by it
+	WorldData.CoarseSpacing = FMath::Max(CoarseSpacing, 1.0f);
+
+	// A manual split past the octave count would add octaves the terrain does not have
+	WorldData.SurfaceSplitOctave = FMath::Clamp(SplitOctave, 0, WorldData.Octaves);
+	WorldData.CaveSplitOctave = FMath::Clamp(SplitOctave, 0, WorldData.Octaves);
+	if (SplitOctave < 0)
+	{
+		const FNoisePermutation& permutation = FNoisePermutation::Get(int32(WorldData.Seed));
+		WorldData.SurfaceSplitOctave = TerrainNoise::PickSplitOctave<2>(permutation, WorldData.Octaves, WorldData.SurfaceFrequency,
+			WorldData.CoarseSpacing / (WorldData.NoiseScale * WorldData.SurfaceNoiseScale), MaxInterpolationError);
+		WorldData.CaveSplitOctave = TerrainNoise::PickSplitOctave<3>(permutation, WorldData.Octaves, WorldData.CaveFrequency,
+			WorldData.CoarseSpacing / (WorldData.NoiseScale * WorldData.CaveNoiseScale), MaxInterpolationError);
+		UE_LOG(LogTemp, Log, TEXT("Split octaves: surface %d cave %d"), WorldData.SurfaceSplitOctave, WorldData.CaveSplitOctave);
+	}
+
+	// Create a shared instanced component for each scatter layer
+	for (auto& layer : ScatterLayers)
+	{
+		auto component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+		component->SetStaticMesh(layer.Mesh);
+		component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		component->SetupAttachment(RootComponent);
+		component->RegisterComponent();
+		AddInstanceComponent(component);
+		ScatterComponents.Add(component);
+	}
+	ScatterOwners.SetNum(ScatterComponents.Num());
+	ScatterInstances.SetNum(ScatterComponents.Num());
+
+	// Start the governor from the editor values
+	Governor.Init(GovernorSettings, RenderDistance, NearRingDistance);
+	if (GovernorSettings.Enabled)
+	{
+		RenderDistance = Governor.RenderDistance;
+		NearRingDistance = Governor.NearRingDistance;
+		WorkerCount = Governor.WorkerCount;
+	}
+
+	WorldData.WaterLevel = WaterLevel;
+	WorldData.ShoreDepth = ShoreDepth;
+	WorldData.ShorelineResolution = ShorelineResolution;
+
+	// Spawn the water once, chunks only update its shoreline mask
+	UClass* waterClass = WaterClass ? WaterClass.Get() : AWaterPlane::StaticClass();
+	Water = GetWorld()->SpawnActor<AWaterPlane>(waterClass);
+
+	// The shoreline mask covers every tile kept at the largest render distance the governor can pick,
+	// so a live tile never shares texels with one being removed
+	int maxRenderDistance = GovernorSettings.Enabled ? FMath::Max(RenderDistance, GovernorSettings.MaxRenderDistance) : RenderDistance;
+	Water->Init(ChunkSize * Scale, 2 * FMath::CeilToInt(maxRenderDistance * 1.5f) + 2, ShorelineResolution, WaterLevel);
+
+	// Spawn the far terrain with a cell per chunk, the voxel chunks cover RenderDistance around the player
+	UClass* farTerrainClass = FarTerrainClass ? FarTerrainClass.Get() : AFarTerrain::StaticClass();
+	FarTerrain = GetWorld()->SpawnActor<AFarTerrain>(farTerrainClass);
+	FarTerrain->Init(WorldData, ChunkSize * Scale, GetVoxelExtent());
 
 	// Initialize tiles
 	CreateChunkArray();
 
 	// Create multithreading worker with tile array
 	TerrainWorker = std::make_unique<FTerrainWorker>(ChunkArray);
+	TerrainWorker->WorkerCount = WorkerCount;
 }
 
 FVector2D AWorldGenerator::GetPlayerGridPosition()
@@ -56,17 +118,17 @@ FVector2D AWorldGenerator::GetChunkPosition(int index)
 }
 
 
-bool AWorldGenerator::IsAlreadyThere(FVector2D position)
+TSet<FIntPoint> AWorldGenerator::GetOccupiedCells()
 {
-	// Check if each grid position has a tile
+	// Grid position of each tile, built once so lookups do not scan every tile
+	TSet<FIntPoint> occupied;
+	occupied.Reserve(ChunkArray.Num());
 	for (int i = 0; i < ChunkArray.Num(); i++)
 	{
-		if (GetChunkPosition(i) == position)
-		{
-			return true;
-		}
+		FVector2D position = GetChunkPosition(i);
+		occupied.Add(FIntPoint(FMath::RoundToInt(position.X), FMath::RoundToInt(position.Y)));
 	}
-	return false;
+	return occupied;
 }
 
 // Called every frame
@@ -74,71 +136,146 @@ void AWorldGenerator::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	// Tiles finished this frame
+	int chunksCompleted = 0;
+
 	// If multithreading worker has been created
 	if (TerrainWorker)
 	{
 		// And has finished it's task
 		if (TerrainWorker->ThreadComplete)
 		{
+			// Destroy prefetched tiles the worker skipped
+			for (int i = ChunkArray.Num() - 1; i >= 0; i--)
+			{
+				if (ChunkArray[i]->Cancelled && !ChunkArray[i]->DataGenerated)
+				{
+					DestroyChunk(ChunkArray[i]);
+					ChunkArray.RemoveAt(i);
+				}
+			}
+
+			// Player grid position for holding back warm prefetched tiles
+			auto PlayerGridPosition = GetPlayerGridPosition();
+			PlayerGridPosition.X = round(PlayerGridPosition.X);
+			PlayerGridPosition.Y = round(PlayerGridPosition.Y);
+
 			// For each tile
 			for (auto& tile : ChunkArray)
 			{
+				// Generated data is held in memory whether or not it is uploaded yet
+				if (tile->DataGenerated && !tile->MeshBytesCounted)
+				{
+					MeshBytes += tile->MeshBytes;
+					tile->MeshBytesCounted = true;
+				}
+
+				// Keep warm prefetched tiles' data until the player is close enough to see them
+				if (IsHeldBack(tile, PlayerGridPosition))
+				{
+					continue;
+				}
+
 				// If the tile does not have a mesh
 				if (!tile->MeshCreated)
 				{
-					// Create the procedural mesh
-					tile->CreateMesh();
+					// Create the procedural mesh, distant tiles are drawn by their super chunk instead
+					if (!tile->Merged)
+					{
+						tile->CreateMesh();
+					}
 					tile->MeshCreated = true;
+					chunksCompleted++;
 
 					// Finish spawning the actor with the same parameters
 					FTransform SpawnParams(tile->GetActorRotation(), tile->GetActorLocation());
 					tile->FinishSpawning(SpawnParams);
 
-					WorkerStarted = false;
-					// Water can now be created
-					/*UpdateWater = true;*/
+					// Batch the scatter placed by the worker into the shared components
+					AddScatter(tile);
+
+					// Write the tile's shoreline into the water mask
+					Water->UpdateShoreline(tile->GetActorLocation(), tile->ShorelineMask);
+
+					// Hand the mesh data over to the tile's super chunk and stop drawing the empty tile mesh
+					if (tile->Merged)
+					{
+						AddToSuperChunk(tile);
+						tile->TerrainMesh->UnregisterComponent();
+					}
 				}
 			}
-			//// If water can be created
-			//if (UpdateWater)
-			//{
-			//	// Create the water mesh
-			//	CreateWaterMesh();
-			//	UpdateWater = false;
-			//}
+
+			// Batch is handled, warm or cancelled tiles may have left nothing to mesh
+			WorkerStarted = false;
 		}
 	}
 
+	// Measure the frame and adjust quality to stay inside the budgets, warm tiles are done and only waiting for the player
+	auto QueueGridPosition = GetPlayerGridPosition();
+	QueueGridPosition.X = round(QueueGridPosition.X);
+	QueueGridPosition.Y = round(QueueGridPosition.Y);
+	int queueDepth = 0;
+	for (auto& tile : ChunkArray)
+	{
+		if (!tile->MeshCreated && !(tile->DataGenerated && IsHeldBack(tile, QueueGridPosition)))
+		{
+			queueDepth++;
+		}
+	}
+	Governor.Record(DeltaTime, chunksCompleted, WorkerStarted || queueDepth > 0);
+	if (Governor.Evaluate(queueDepth, MeshBytes))
+	{
+		ApplyQuality();
+	}
+
+	// Take tiles the player moved close to out of their super chunks, then rebuild changed super chunks and destroy empty ones
+	UnmergeNearChunks();
+	UpdateSuperChunks();
+
+	// Keep the water centred on the player
+	Water->Follow(GetWorld()->GetFirstPlayerController()->GetPawn()->GetActorLocation());
+
 	// Get players position on grid
 	auto PlayerGridPosition = GetPlayerGridPosition();
 	PlayerGridPosition.X = round(PlayerGridPosition.X);
 	PlayerGridPosition.Y = round(PlayerGridPosition.Y);
 
+	// Mask the shoreline and far terrain to the area covered by voxel tiles
+	FVector VoxelCenter = GetVoxelCenter(PlayerGridPosition);
+	Water->SetShorelineWindow(VoxelCenter, GetVoxelExtent());
+	FarTerrain->SetVoxelArea(VoxelCenter, GetVoxelExtent());
+
+	// Keep the far terrain centred on the player
+	FarTerrain->Follow(GetWorld()->GetFirstPlayerController()->GetPawn()->GetActorLocation());
+
 	// If multithreading worker has completed
 	if (TerrainWorker->ThreadComplete)
 	{
 		// For each tile
 		for (int i = 0; i < ChunkArray.Num(); i++)
 		{
-			// Get the distance between the tile and the player
-			auto PlayerLocation = FVector{ PlayerGridPosition.X * 255, PlayerGridPosition.Y * 255,0 };
-			auto TileLocation = ChunkArray[i]->GetActorLocation();
-			auto Distance = (PlayerLocation - TileLocation).Size();
-
-			// Max distance to delete tiles
-			auto MaxDistance = (RenderDistance * ChunkSize * Scale * 1.5f);
-
 			// If the tile is further than the max distance
-			if (Distance > MaxDistance)
+			if (!IsInKeepDistance(ChunkArray[i]->GetActorLocation(), PlayerGridPosition))
 			{
-				// Remove all owned actors from tile
-				//ChunkArray[i]->RemoveTrees();
-				//ChunkArray[i]->RemoveRocks();
-				//ChunkArray[i]->RemoveGrass();
-				//ChunkArray[i]->RemoveAnimals();
+				// Remove all scatter instances owned by the tile
+				RemoveScatter(ChunkArray[i]);
+
+				// Forget the tile's shoreline so the mask never shows it for another tile
+				Water->ClearShoreline(ChunkArray[i]->GetActorLocation());
+
+				// Remove the tile from its super chunk mesh
+				if (ChunkArray[i]->Merged)
+				{
+					RemoveFromSuperChunk(ChunkArray[i]);
+				}
 
 				// Destroy the tile and remove from the array
-				ChunkArray[i]->Destroy();
+				if (ChunkArray[i]->MeshBytesCounted)
+				{
+					MeshBytes -= ChunkArray[i]->MeshBytes;
+				}
+				DestroyChunk(ChunkArray[i]);
 				ChunkArray.RemoveAt(i);
 			}
 		}
@@ -146,13 +283,21 @@ void AWorldGenerator::Tick(float DeltaTime)
 
 	if (!WorkerStarted)
 	{
-		if (CreateChunkArray())
+		// Only prefetch when every visible tile is already queued so prefetching never delays them
+		bool newChunks = CreateChunkArray();
+		if (!newChunks && PrefetchEnabled)
+		{
+			newChunks = PrefetchChunks();
+		}
+
+		if (newChunks)
 		{
 			// If the multithreading worker has completed
 			if (TerrainWorker->ThreadComplete)
 			{
 				// Restart the multithreading worker with the new tiles
 				TerrainWorker->InputChunks(ChunkArray);
+				TerrainWorker->WorkerCount = WorkerCount;
 				TerrainWorker->ThreadComplete = false;
 				WorkerStarted = true;
 			}
@@ -163,7 +308,8 @@ void AWorldGenerator::Tick(float DeltaTime)
 	// If the player's grid position has changed
 	if (PlayerGridPosition != LastPlayerPosition)
 	{
-		
+		// Stop generating prefetched tiles the player did not head towards so visible tiles can start
+		CancelPrefetch(PlayerGridPosition);
 	}
 
 	// Record the last player position
@@ -180,42 +326,347 @@ bool AWorldGenerator::CreateChunkArray()
 	PlayerGridPosition.Y = round(PlayerGridPosition.Y);
 
 	// Test the area around the player to ensure no duplicate tiles
+	TSet<FIntPoint> occupied = GetOccupiedCells();
 	for (int x = -RenderDistance; x < RenderDistance; x++)
 	{
 		for (int y = -RenderDistance; y < RenderDistance; y++)
 		{
 			// If there is room for a tile
-			if (!IsAlreadyThere(FVector2D{ PlayerGridPosition.X + x, PlayerGridPosition.Y + y }))
+			if (!occupied.Contains(FIntPoint(FMath::RoundToInt(PlayerGridPosition.X) + x, FMath::RoundToInt(PlayerGridPosition.Y) + y)))
 			{
-				// Create spawn parameters
-				FVector Location(((PlayerGridPosition.X + x) * ChunkSize * Scale), ((PlayerGridPosition.Y + y) * ChunkSize * Scale), 0.0f);
-				FRotator Rotation(0.0f, 0.0f, 0.0f);
-				FTransform SpawnParams(Rotation, Location);
+				SpawnChunk(PlayerGridPosition, x, y);
 
-				// Begin the spawning of the actor. Use deferred spawning to allow mulithreading worker to complete.
-				ATerrainChunk* chunk = GetWorld()->SpawnActorDeferred<ATerrainChunk>(TerrainClass, SpawnParams);
+				ret = true;
+			}
+		}
+	}
+	return ret;
 
-				WorldData.CubeSize = 64;
-				if (x < RenderDistance / 3 && x > -RenderDistance / 3)
-				{
-					WorldData.CubeSize = 32;
-				}
-				if (y < RenderDistance / 3 && y > -RenderDistance / 3)
-				{
-					WorldData.CubeSize = 32;
-				}
+}
 
-				// Initialize the tile with the values set in the editor
-				chunk->Init(WorldData);
+ATerrainChunk* AWorldGenerator::SpawnChunk(FVector2D center, int x, int y)
+{
+	// Create spawn parameters
+	FVector Location(((center.X + x) * ChunkSize * Scale), ((center.Y + y) * ChunkSize * Scale), 0.0f);
+	FRotator Rotation(0.0f, 0.0f, 0.0f);
+	FTransform SpawnParams(Rotation, Location);
 
-				// Save the tile in the array
-				ChunkArray.Push(chunk);
+	// Begin the spawning of the actor. Use deferred spawning to allow mulithreading worker to complete.
+	ATerrainChunk* chunk = GetWorld()->SpawnActorDeferred<ATerrainChunk>(TerrainClass, SpawnParams);
 
-				ret = true;
+	WorldData.CubeSize = 64;
+	WorldData.ScatterDensity = FarScatterDensity;
+	if (IsInNearRing(x, y))
+	{
+		WorldData.CubeSize = 32;
+		WorldData.ScatterDensity = NearScatterDensity;
+	}
+
+	// Initialize the tile with the values set in the editor
+	chunk->Init(WorldData);
+	chunk->Merged = IsMergeable(x, y);
+
+	// Save the tile in the array
+	ChunkArray.Push(chunk);
+
+	return chunk;
+}
+
+bool AWorldGenerator::PrefetchChunks()
+{
+	auto PlayerGridPosition = GetPlayerGridPosition();
+	PlayerGridPosition.X = round(PlayerGridPosition.X);
+	PlayerGridPosition.Y = round(PlayerGridPosition.Y);
+
+	FVector2D PredictedGridPosition = GetPredictedGridPosition();
+
+	// Not moving fast enough to leave the current cell
+	if (PredictedGridPosition == PlayerGridPosition)
+	{
+		return false;
+	}
+
+	// Prefetched tiles already waiting outside the render area
+	int resident = 0;
+	for (auto& tile : ChunkArray)
+	{
+		if (tile->Prefetched && !IsInRenderArea(GetChunkGridPosition(tile), PlayerGridPosition))
+		{
+			resident++;
+		}
+	}
+	if (resident >= MaxPrefetchedTiles)
+	{
+		return false;
+	}
+
+	// Missing tiles around the predicted position the destroy pass would keep, nearest to the player first
+	TArray<FVector2D> cells;
+	TSet<FIntPoint> occupied = GetOccupiedCells();
+	for (int x = -RenderDistance; x < RenderDistance; x++)
+	{
+		for (int y = -RenderDistance; y < RenderDistance; y++)
+		{
+			FVector2D cell(PredictedGridPosition.X + x, PredictedGridPosition.Y + y);
+			FVector cellLocation(cell.X * ChunkSize * Scale, cell.Y * ChunkSize * Scale, 0.0f);
+			if (!IsInRenderArea(cell, PlayerGridPosition) && IsInKeepDistance(cellLocation, PlayerGridPosition) && !occupied.Contains(FIntPoint(FMath::RoundToInt(cell.X), FMath::RoundToInt(cell.Y))))
+			{
+				cells.Add(cell);
 			}
 		}
 	}
-	return ret;
+	cells.Sort([&](const FVector2D& a, const FVector2D& b)
+	{
+		return FVector2D::DistSquared(a, PlayerGridPosition) < FVector2D::DistSquared(b, PlayerGridPosition);
+	});
+
+	// Cap the batch so the worker is back for visible tiles quickly, and the tiles waiting outside the render area
+	int count = FMath::Min3(cells.Num(), MaxPrefetchChunks, MaxPrefetchedTiles - resident);
+	for (int i = 0; i < count; i++)
+	{
+		// LOD ring taken from where the player is predicted to be
+		auto chunk = SpawnChunk(PredictedGridPosition, cells[i].X - PredictedGridPosition.X, cells[i].Y - PredictedGridPosition.Y);
+		chunk->Prefetched = true;
+	}
+
+	return count > 0;
+}
+
+void AWorldGenerator::CancelPrefetch(FVector2D center)
+{
+	// Tiles still ahead of the player are about to be needed, only cancel ones it turned away from
+	FVector2D PredictedGridPosition = GetPredictedGridPosition();
+	for (auto& tile : ChunkArray)
+	{
+		FVector2D position = GetChunkGridPosition(tile);
+		if (tile->Prefetched && !tile->DataGenerated && !IsInRenderArea(position, center) && !IsInRenderArea(position, PredictedGridPosition))
+		{
+			tile->Cancelled = true;
+		}
+	}
+}
+
+FVector2D AWorldGenerator::GetPredictedGridPosition()
+{
+	// Extrapolate the player's position over the horizon
+	APawn* pawn = GetWorld()->GetFirstPlayerController()->GetPawn();
+	FVector PredictedPosition = pawn->GetActorLocation() + pawn->GetVelocity() * PrefetchHorizon;
+	return FVector2D(round(PredictedPosition.X / (ChunkSize * Scale)), round(PredictedPosition.Y / (ChunkSize * Scale)));
+}
+
+bool AWorldGenerator::IsInRenderArea(FVector2D position, FVector2D center)
+{
+	// Same area CreateChunkArray fills
+	FVector2D offset = position - center;
+	return offset.X >= -RenderDistance && offset.X < RenderDistance && offset.Y >= -RenderDistance && offset.Y < RenderDistance;
+}
 
+FVector2D AWorldGenerator::GetChunkGridPosition(ATerrainChunk* chunk)
+{
+	FVector TileGridPosition = chunk->GetActorLocation() / (ChunkSize * Scale);
+	return FVector2D(round(TileGridPosition.X), round(TileGridPosition.Y));
 }
 
+bool AWorldGenerator::IsInKeepDistance(FVector tileLocation, FVector2D playerGridPosition)
+{
+	// Get the distance between the tile and the player
+	auto PlayerLocation = FVector{ playerGridPosition.X * 255, playerGridPosition.Y * 255,0 };
+	auto Distance = (PlayerLocation - tileLocation).Size();
+
+	// Max distance to delete tiles
+	auto MaxDistance = (RenderDistance * ChunkSize * Scale * 1.5f);
+
+	return Distance <= MaxDistance;
+}
+
+bool AWorldGenerator::IsHeldBack(ATerrainChunk* chunk, FVector2D playerGridPosition)
+{
+	return chunk->Prefetched && PrefetchWarmOnly && !chunk->MeshCreated && !IsInRenderArea(GetChunkGridPosition(chunk), playerGridPosition);
+}
+
+void AWorldGenerator::DestroyChunk(ATerrainChunk* chunk)
+{
+	// Deferred tiles are finished when their mesh is created, finish any that never got there before destroying
+	if (!chunk->MeshCreated)
+	{
+		FTransform SpawnParams(chunk->GetActorRotation(), chunk->GetActorLocation());
+		chunk->FinishSpawning(SpawnParams);
+	}
+	chunk->Destroy();
+}
+
+FVector AWorldGenerator::GetVoxelCenter(FVector2D playerGridPosition)
+{
+	// Tiles span [-RenderDistance, RenderDistance) around the player, each reaching half a tile either side
+	return FVector((playerGridPosition.X - 0.5f) * ChunkSize * Scale, (playerGridPosition.Y - 0.5f) * ChunkSize * Scale, 0);
+}
+
+float AWorldGenerator::GetVoxelExtent()
+{
+	return RenderDistance * ChunkSize * Scale;
+}
+
+
+
+void AWorldGenerator::AddScatter(ATerrainChunk* chunk)
+{
+	for (int layer = 0; layer < ScatterComponents.Num() && layer < chunk->ScatterTransforms.Num(); layer++)
+	{
+		auto& transforms = chunk->ScatterTransforms[layer];
+		if (transforms.Num() == 0)
+		{
+			continue;
+		}
+
+		// Add every instance for the chunk in one call, transforms are already in world space
+		ScatterComponents[layer]->AddInstances(transforms, false, true);
+		auto& owners = ScatterOwners[layer];
+		auto& instances = ScatterInstances[layer].FindOrAdd(chunk);
+		for (int i = 0; i < transforms.Num(); i++)
+		{
+			owners.Add(TPair<ATerrainChunk*, int32>(chunk, instances.Num()));
+			instances.Add(owners.Num() - 1);
+		}
+	}
+
+	// Instances now live in the components
+	chunk->ScatterTransforms.Empty();
+}
+
+void AWorldGenerator::RemoveScatter(ATerrainChunk* chunk)
+{
+	for (int layer = 0; layer < ScatterComponents.Num(); layer++)
+	{
+		auto& owners = ScatterOwners[layer];
+
+		// Take the chunk's instances highest index first
+		TArray<int32> instances;
+		if (!ScatterInstances[layer].RemoveAndCopyValue(chunk, instances) || instances.Num() == 0)
+		{
+			continue;
+		}
+		instances.Sort(TGreater<int32>());
+
+		// Hierarchical instances are removed by swapping in the last instance, so mirror that on the owners
+		// and point the moved instance's owner at its new index. The last instance is never one of this
+		// chunk's, those above the current index are already gone
+		ScatterComponents[layer]->RemoveInstances(instances);
+		for (auto instance : instances)
+		{
+			int last = owners.Num() - 1;
+			if (instance != last)
+			{
+				auto& moved = owners[last];
+				ScatterInstances[layer][moved.Key][moved.Value] = instance;
+				owners[instance] = moved;
+			}
+			owners.Pop(false);
+		}
+	}
+}
+
+void AWorldGenerator::ApplyQuality()
+{
+	RenderDistance = Governor.RenderDistance;
+	NearRingDistance = Governor.NearRingDistance;
+	WorkerCount = Governor.WorkerCount;
+
+	// Tiles outside the new distance are removed by Tick, tiles inside keep the LOD they were made with
+	auto PlayerGridPosition = GetPlayerGridPosition();
+	PlayerGridPosition.X = round(PlayerGridPosition.X);
+	PlayerGridPosition.Y = round(PlayerGridPosition.Y);
+	FarTerrain->SetVoxelArea(GetVoxelCenter(PlayerGridPosition), GetVoxelExtent());
+	Water->SetShorelineWindow(GetVoxelCenter(PlayerGridPosition), GetVoxelExtent());
+}
+
+FIntPoint AWorldGenerator::GetSuperChunkKey(FVector location)
+{
+	// Tile grid position divided down to the super chunk grid
+	int x = FMath::RoundToInt(location.X / (ChunkSize * Scale));
+	int y = FMath::RoundToInt(location.Y / (ChunkSize * Scale));
+	return FIntPoint(FMath::FloorToInt(float(x) / SuperChunkSize), FMath::FloorToInt(float(y) / SuperChunkSize));
+}
+
+void AWorldGenerator::AddToSuperChunk(ATerrainChunk* chunk)
+{
+	FIntPoint key = GetSuperChunkKey(chunk->GetActorLocation());
+
+	auto superChunk = SuperChunks.Find(key);
+	if (!superChunk)
+	{
+		// Create a component at the corner of the super chunk to draw its members
+		auto mesh = NewObject<UProceduralMeshComponent>(this);
+		mesh->SetupAttachment(RootComponent);
+		mesh->SetWorldLocation(FVector(key.X, key.Y, 0) * SuperChunkSize * ChunkSize * Scale);
+		mesh->RegisterComponent();
+		AddInstanceComponent(mesh);
+
+		superChunk = &SuperChunks.Add(key, MakeUnique<FSuperChunk>(mesh));
+	}
+
+	(*superChunk)->AddMember(chunk);
+}
+
+void AWorldGenerator::RemoveFromSuperChunk(ATerrainChunk* chunk, bool returnMesh)
+{
+	if (auto superChunk = SuperChunks.Find(GetSuperChunkKey(chunk->GetActorLocation())))
+	{
+		(*superChunk)->RemoveMember(chunk, returnMesh);
+	}
+}
+
+void AWorldGenerator::UnmergeNearChunks()
+{
+	auto PlayerGridPosition = GetPlayerGridPosition();
+	PlayerGridPosition.X = round(PlayerGridPosition.X);
+	PlayerGridPosition.Y = round(PlayerGridPosition.Y);
+
+	for (auto& tile : ChunkArray)
+	{
+		// Only tiles already handed to a super chunk, the worker never touches these again
+		if (!tile->Merged || !tile->MeshCreated)
+		{
+			continue;
+		}
+
+		FVector2D offset = GetChunkGridPosition(tile) - PlayerGridPosition;
+		if (IsMergeable(offset.X, offset.Y))
+		{
+			continue;
+		}
+
+		// Take the mesh data back and draw it with the tile's own mesh, at the LOD it was made with
+		RemoveFromSuperChunk(tile, true);
+		tile->Merged = false;
+		tile->TerrainMesh->RegisterComponent();
+		tile->MeshCreated = false;
+		tile->CreateMesh();
+	}
+}
+
+bool AWorldGenerator::IsInNearRing(int x, int y)
+{
+	// Same rule SpawnChunk uses to pick the near LOD
+	return (x < NearRingDistance && x > -NearRingDistance) || (y < NearRingDistance && y > -NearRingDistance);
+}
+
+bool AWorldGenerator::IsMergeable(int x, int y)
+{
+	// Square ring outside the near ring, so tiles far out along an axis merge too
+	return SuperChunkSize > 1 && FMath::Max(FMath::Abs(x), FMath::Abs(y)) >= NearRingDistance;
+}
+
+void AWorldGenerator::UpdateSuperChunks()
+{
+	for (auto it = SuperChunks.CreateIterator(); it; ++it)
+	{
+		it->Value->Update();
+
+		// Destroy the component once the last member has gone
+		if (it->Value->IsEmpty())
+		{
+			it->Value->Mesh->DestroyComponent();
+			it.RemoveCurrent();
+		}
+	}
+}
@@ -5,8 +5,14 @@
 #include "TerrainChunk.h"
 
 #include "TerrainWorker.h"
+#include "WaterPlane.h"
+#include "FarTerrain.h"
+#include "SuperChunk.h"
+#include "QualityGovernor.h"
 #include <memory>
 
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "WorldGenerator.generated.h"
@@ -42,6 +48,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Chunks")
 	int RenderDistance = 18;
 
+	// Number of tiles in each direction using the near LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Chunks")
+	int NearRingDistance = 6;
+
 	// Size (x,y) of each tile
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Chunks")
 	float ChunkSize = 256;
@@ -54,17 +64,180 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Chunks")
 	int Scale = 1;
 
+	// Spacing of the lattice each chunk samples its low frequency octaves on
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Noise", meta = (ClampMin = "1"))
+	float CoarseSpacing = 64;
+
+	// Octaves below this come from the lattice, -1 picks it from MaxInterpolationError
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Noise")
+	int SplitOctave = -1;
+
+	// Largest density error allowed from interpolating the low octaves
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Noise")
+	float MaxInterpolationError = 0.005f;
+
+	// Foliage and rock layers scattered over each chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Scatter")
+	TArray<FScatterLayer> ScatterLayers;
+
+	// Scatter density multiplier for chunks in the near LOD ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Scatter")
+	float NearScatterDensity = 1.0f;
+
+	// Scatter density multiplier for chunks in the far LOD ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Scatter")
+	float FarScatterDensity = 0.25f;
+
+	// One instanced component per scatter layer, shared by every chunk
+	UPROPERTY(VisibleAnywhere)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> ScatterComponents;
+
+	// Chunk owning each instance and the instance's slot in that chunk's index list, kept parallel to the instances of each scatter component
+	TArray<TArray<TPair<ATerrainChunk*, int32>>> ScatterOwners;
+
+	// Instance indices owned by each chunk in each scatter component
+	TArray<TMap<ATerrainChunk*, TArray<int32>>> ScatterInstances;
+
+	// Add a chunk's generated scatter instances to the shared components
+	void AddScatter(ATerrainChunk* chunk);
+
+	// Remove all scatter instances owned by a chunk
+	void RemoveScatter(ATerrainChunk* chunk);
+
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<AWaterPlane> WaterClass;
+
+	// Water clipmap following the player
+	UPROPERTY(VisibleAnywhere)
+	AWaterPlane* Water;
+
+	// World height of the water surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Water")
+	float WaterLevel = 550;
+
+	// Depth at which the shoreline mask reaches deep water
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Water")
+	float ShoreDepth = 100;
+
+	// Shoreline mask texels along each side of a chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Water")
+	int ShorelineResolution = 4;
+
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<AFarTerrain> FarTerrainClass;
+
+	// Heightmap clipmap rendered past RenderDistance
+	UPROPERTY(VisibleAnywhere)
+	AFarTerrain* FarTerrain;
+
+	// Tiles along each side of a super chunk merging distant tiles, 1 disables merging
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Chunks")
+	int SuperChunkSize = 4;
+
+	// Super chunks by super chunk grid position
+	TMap<FIntPoint, TUniquePtr<FSuperChunk>> SuperChunks;
+
+	// Returns super chunk grid position of a tile location
+	FIntPoint GetSuperChunkKey(FVector location);
+
+	// Hand a distant tile's mesh to its super chunk
+	void AddToSuperChunk(ATerrainChunk* chunk);
+
+	// Remove a distant tile from its super chunk, optionally handing its mesh data back
+	void RemoveFromSuperChunk(ATerrainChunk* chunk, bool returnMesh = false);
+
+	// Give merged tiles the player moved close to their own mesh again
+	void UnmergeNearChunks();
+
+	// Returns true if a tile offset from the player grid position gets the near LOD
+	bool IsInNearRing(int x, int y);
+
+	// Returns true if a tile offset from the player grid position is far enough out to be drawn by a super chunk
+	bool IsMergeable(int x, int y);
+
+	// Apply finished super chunk builds and start new ones
+	void UpdateSuperChunks();
+
+	// Limits for adjusting quality at runtime
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Governor")
+	FGovernorSettings GovernorSettings;
+
+	// Adjusts render distance, LOD ring and worker count to the machine
+	FQualityGovernor Governor;
+
+	// Number of tiles the worker generates at once
+	int WorkerCount = 1;
+
+	// Approximate memory held by tile meshes
+	int64 MeshBytes = 0;
+
+	// Apply the quality picked by the governor
+	void ApplyQuality();
+
+	// Generate tiles ahead of the player from its velocity
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Prefetch")
+	bool PrefetchEnabled = true;
+
+	// Seconds ahead to extrapolate the player's position
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Prefetch")
+	float PrefetchHorizon = 2.0f;
+
+	// Most tiles to prefetch in one batch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Prefetch")
+	int MaxPrefetchChunks = 32;
+
+	// Most prefetched tiles kept outside the render area at once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Prefetch")
+	int MaxPrefetchedTiles = 128;
+
+	// Only generate prefetched tiles, upload their meshes once they enter the render area
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Generation|Prefetch")
+	bool PrefetchWarmOnly = true;
+
 	// Begin spawning new tiles in required locations
 	bool CreateChunkArray();
 
+	// Spawn a tile at an offset from a grid position, the offset picks its LOD ring
+	ATerrainChunk* SpawnChunk(FVector2D center, int x, int y);
+
+	// Spawn tiles around where the player is heading, returns true if any were spawned
+	bool PrefetchChunks();
+
+	// Cancel prefetched tiles not generated yet that are outside both the render area and the predicted area
+	void CancelPrefetch(FVector2D center);
+
+	// Returns the rounded grid position the player is predicted to reach over the prefetch horizon
+	FVector2D GetPredictedGridPosition();
+
+	// Returns true if a tile grid position is inside the render area around a grid position
+	bool IsInRenderArea(FVector2D position, FVector2D center);
+
+	// Returns rounded grid position of a tile
+	FVector2D GetChunkGridPosition(ATerrainChunk* chunk);
+
+	// Returns true if a tile location is close enough to the player grid position to be kept
+	bool IsInKeepDistance(FVector tileLocation, FVector2D playerGridPosition);
+
+	// Returns true if a prefetched tile is held back from meshing until it enters the render area
+	bool IsHeldBack(ATerrainChunk* chunk, FVector2D playerGridPosition);
+
+	// Finish spawning a tile if it never was and destroy it
+	void DestroyChunk(ATerrainChunk* chunk);
+
+	// Returns the centre of the area covered by voxel tiles around a rounded player grid position
+	FVector GetVoxelCenter(FVector2D playerGridPosition);
+
+	// Returns the half width of the area covered by voxel tiles
+	float GetVoxelExtent();
+
 	// Returns player grid position
 	FVector2D GetPlayerGridPosition();
 
 	// Returns tile grid position
 	FVector2D GetChunkPosition(int index);
 
-	// Returns false if theres is no tile at position
-	bool IsAlreadyThere(FVector2D position);
+	// Returns the grid position of every tile
+	TSet<FIntPoint> GetOccupiedCells();
 
 	// Last player position recorded
 	FVector2D LastPlayerPosition = { 0,0 };